@@ -0,0 +1,248 @@
+//          Copyright Michael Florian Hava.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file ../../LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <ios>
+#include <array>
+#include <regex>
+#include <future>
+#include <string>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+	struct counter_impl final {
+		int value{0};
+
+		auto increment() noexcept -> int { return ++value; }
+		auto add(int value) -> int {
+			if(value < 0) throw std::invalid_argument{"negative value"};
+			return this->value += value;
+		}
+		auto history(int value) -> std::array<int, 8> {
+			if(value < 0) throw std::invalid_argument{"negative value"};
+			return {this->value += value, this->value - 1, this->value - 2, this->value - 3, this->value - 4, this->value - 5, this->value - 6, this->value - 7};
+		}
+	};
+}
+
+#ifndef CWC_BENCHMARK_DLL
+	#define CWC_DIRECT_3cwc9benchmark14linked_counter counter_impl
+#endif
+#include "benchmark.cwch"
+
+#ifndef CWC_BENCHMARK_DLL
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#ifdef __linux__
+	#include <filesystem>
+	#include <dlfcn.h>
+#endif
+
+namespace {
+	constexpr
+	std::size_t bundle_size{40};
+
+	const auto bundle{[] {
+		std::array<std::string, bundle_size> result;
+		for(std::size_t i{0}; i < result.size(); ++i) result[i] = "3cwc9benchmark6bundleT_" + std::to_string(i) + "E";
+		return result;
+	}()};
+}
+
+TEST_CASE("bundle startup", "[loading]") {
+	auto shared{[] {
+		std::array<std::optional<cwc::internal::context>, bundle_size> contexts;
+		for(std::size_t i{0}; i < bundle_size; ++i) contexts[i].emplace("benchmark-cwc", bundle[i].c_str(), 0);
+	}};
+
+#ifdef __linux__
+	auto baseline{[base_path{std::filesystem::read_symlink("/proc/self/exe").remove_filename()}] { //emulates the previous behavior of building the path and loading the library per component
+		cwc::internal::context ctx{"benchmark-cwc", bundle[0].c_str(), 0}; //ensures the library is loaded by CWC as well
+		std::array<void *, bundle_size> handles;
+		for(std::size_t i{0}; i < bundle_size; ++i) {
+			auto fullpath{base_path};
+			fullpath += "libbenchmark-cwc.so";
+			handles[i] = dlopen(fullpath.c_str(), RTLD_NOW);
+			const auto exports{handles[i] ? reinterpret_cast<decltype(&cwc_exports)>(dlsym(handles[i], "cwc_exports")) : nullptr};
+			if(!exports) throw std::runtime_error{"could not load component"};
+			const auto table{exports()};
+			const auto hash{cwc::internal::hash(bundle[i].c_str())};
+			const auto it{std::lower_bound(table->entries, table->entries + table->count, hash, [](const cwc::internal::exported & e, std::uint64_t h) { return e.hash < h; })};
+			if(it == table->entries + table->count || it->hash != hash) throw std::runtime_error{"could not load component"};
+		}
+		for(auto handle : handles) dlclose(handle);
+	}};
+#endif
+
+	BENCHMARK("cold: 1 component") {
+		cwc::internal::context ctx{"benchmark-cwc", bundle[0].c_str(), 0};
+	};
+	BENCHMARK("cold: 40 components, shared library handle") { shared(); };
+#ifdef __linux__
+	BENCHMARK("cold: 40 components, library handle per component (baseline)") { baseline(); };
+#endif
+
+	const cwc::internal::context keep_alive{"benchmark-cwc", bundle[0].c_str(), 0};
+	BENCHMARK("warm: 40 components, shared library handle") { shared(); };
+#ifdef __linux__
+	BENCHMARK("warm: 40 components, library handle per component (baseline)") { baseline(); };
+#endif
+}
+
+TEST_CASE("call overhead", "[calls]") {
+	struct vtable final { //mirrors the vtable generated for cwc::benchmark::counter
+		void(*cwc_0)(cwc::internal::call_context<void, true> *, void *) noexcept;
+		void(*cwc_1)(cwc::internal::call_context<void, false> *, void **) noexcept;
+		int(*cwc_2)(void *) noexcept;
+	};
+
+	const cwc::internal::context ctx{"benchmark-cwc", "3cwc9benchmark7counter", 0};
+	void * self;
+	cwc::internal::dispatch vptr;
+	const auto binding{ctx.construct<&vtable::cwc_1>(vptr, &self)};
+	BENCHMARK("vtable via binding (baseline)") { return binding->call<&vtable::cwc_2>(self); };
+	BENCHMARK("vtable cached in handle") { return vptr.call<&vtable::cwc_2>(self); };
+	cwc::internal::context::destroy<&vtable::cwc_0>(binding, self);
+
+	cwc::benchmark::counter counter;
+	BENCHMARK("generated handle") { return counter.increment(); };
+	BENCHMARK("generated handle, may throw, in registers") { return counter.add(1); };
+	BENCHMARK("generated handle, may throw, in memory") { return counter.history(1); };
+
+	cwc::benchmark::linked_counter linked;
+	BENCHMARK("generated handle, direct call") { return linked.increment(); };
+}
+
+TEST_CASE("call context", "[calls]") { //success path only, measures the overhead of the boundary itself
+	BENCHMARK("may throw, result in registers") {
+		cwc::internal::call_context<int, false> ctx{false};
+		const auto result{ctx.try_([] { return 42; })};
+		ctx.return_();
+		return result;
+	};
+	BENCHMARK("may throw, result in memory") {
+		cwc::internal::call_context<std::array<int, 8>, false> ctx{false};
+		ctx.try_([] { return std::array<int, 8>{42}; });
+		return ctx.return_();
+	};
+	BENCHMARK("may throw, native exceptions") {
+		cwc::internal::call_context<std::array<int, 8>, false> ctx{true};
+		ctx.try_([] { return std::array<int, 8>{42}; });
+		return ctx.return_();
+	};
+	BENCHMARK("may throw, no result") {
+		cwc::internal::call_context<void, false> ctx{false};
+		ctx.try_([] {});
+		ctx.return_();
+	};
+}
+
+TEST_CASE("exceptions", "[exceptions]") { //capture and rethrow at the boundary, mixed toolsets => mapped to the closest standard exception
+	const auto roundtrip{[](auto exc) {
+		cwc::internal::call_context<void, false> ctx{false};
+		ctx.try_([&] { throw exc; });
+		try { ctx.return_(); }
+		catch(const std::exception &) { return true; }
+		return false;
+	}};
+	BENCHMARK("std::exception") { return roundtrip(std::exception{}); };
+	BENCHMARK("std::logic_error") { return roundtrip(std::logic_error{"logic"}); };
+	BENCHMARK("std::invalid_argument") { return roundtrip(std::invalid_argument{"invalid"}); };
+	BENCHMARK("std::future_error") { return roundtrip(std::future_error{std::future_errc::no_state}); };
+	BENCHMARK("std::runtime_error") { return roundtrip(std::runtime_error{"runtime"}); };
+	BENCHMARK("std::ios_base::failure") { return roundtrip(std::ios_base::failure{"failure"}); };
+	BENCHMARK("std::regex_error") { return roundtrip(std::regex_error{std::regex_constants::error_stack}); };
+	BENCHMARK("std::bad_alloc") { return roundtrip(std::bad_alloc{}); };
+	BENCHMARK("std::bad_optional_access") { return roundtrip(std::bad_optional_access{}); };
+	BENCHMARK("derived from std::runtime_error") { return roundtrip(std::system_error{std::make_error_code(std::errc::io_error)}); };
+	BENCHMARK("not derived from std::exception") { return roundtrip(0); };
+}
+
+TEST_CASE("batches", "[calls]") {
+	cwc::benchmark::counter counter;
+	std::vector<int> in(1000, 1), out(in.size());
+	BENCHMARK("1000 calls (baseline)") {
+		for(std::size_t i{0}; i < in.size(); ++i) out[i] = counter.add(in[i]);
+		return out.back();
+	};
+	BENCHMARK("1 batch of 1000") {
+		counter.add(in, out);
+		return out.back();
+	};
+}
+
+TEST_CASE("lifetime", "[calls]") {
+	BENCHMARK("allocated on the heap (baseline)") { return cwc::benchmark::counter{}.increment(); };
+	BENCHMARK("stored in the handle") { return cwc::benchmark::inlined_counter{}.increment(); };
+	BENCHMARK("recycled by a pool") { return cwc::benchmark::pooled_counter{}.increment(); };
+}
+
+TEST_CASE("failures", "[calls]") {
+	cwc::benchmark::counter counter;
+	BENCHMARK("thrown (baseline)") {
+		try { return counter.add(-1); }
+		catch(const std::invalid_argument &) { return 0; }
+	};
+	BENCHMARK("reported") {
+		const auto result{counter.try_add(-1)};
+		return result ? *result : 0;
+	};
+}
+
+#else
+namespace {
+	struct impl final {};
+}
+
+CWC_EXPORT_3cwc9benchmark6bundleT_0E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_1E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_2E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_3E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_4E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_5E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_6E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_7E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_8E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_9E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_10E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_11E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_12E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_13E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_14E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_15E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_16E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_17E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_18E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_19E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_20E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_21E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_22E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_23E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_24E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_25E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_26E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_27E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_28E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_29E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_30E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_31E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_32E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_33E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_34E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_35E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_36E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_37E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_38E(impl);
+CWC_EXPORT_3cwc9benchmark6bundleT_39E(impl);
+CWC_EXPORT_3cwc9benchmark7counter(counter_impl);
+CWC_EXPORT_3cwc9benchmark14linked_counter(counter_impl);
+CWC_EXPORT_3cwc9benchmark15inlined_counter(counter_impl);
+CWC_EXPORT_3cwc9benchmark14pooled_counter(counter_impl, cwc::pool_allocation<>);
+CWC_EXPORTS_benchmark_cwc();
+#endif
@@ -8,140 +8,768 @@
 
 #if defined(__GNUG__)
 	#define CWC_EXPORT __attribute__((visibility("default")))
+	#define CWC_LOCAL __attribute__((visibility("hidden")))
 #elif defined(_MSC_VER)
 	#define CWC_EXPORT __declspec(dllexport)
+	#define CWC_LOCAL
 #else
 	#error unknown compiler
 #endif
 
+#include <new>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <iosfwd>
+#include <future>
+#include <limits>
 #include <memory>
+#include <tuple>
+#include <string>
+#include <vector>
+#include <cstddef>
 #include <cstdint>
 #include <utility>
+#include <iterator>
+#include <optional>
+#include <variant>
+#include <algorithm>
+#include <stdexcept>
+#include <exception>
+#include <filesystem>
 #include <type_traits>
+#include <system_error>
+#include <initializer_list>
 
 namespace cwc::internal {
 	using version = std::uint8_t;
 
 
+	constexpr
+	auto hash(const char * str) noexcept -> std::uint64_t { //FNV-1a
+		std::uint64_t result{0xcbf29ce484222325};
+		while(*str) result = (result ^ static_cast<unsigned char>(*str++)) * 0x100000001b3;
+		return result;
+	}
+
+
+	constexpr
+	auto toolset_fingerprint() noexcept -> std::uint32_t { //compiler, standard library and their ABI relevant settings, 0 => unknown toolset
+		constexpr
+		std::uint64_t values[]{
+		#if defined(__clang__)
+			hash("clang " __clang_version__),
+		#elif defined(__GNUC__)
+			hash("gcc " __VERSION__),
+		#elif defined(_MSC_VER) && defined(_DLL)
+			hash("msvc"), _MSC_FULL_VER,
+		#else
+			0, //includes MSVC with static runtime => every module has its own exception handling
+		#endif
+		#if defined(_LIBCPP_VERSION)
+			hash("libc++"), _LIBCPP_VERSION, _LIBCPP_ABI_VERSION,
+		#elif defined(__GLIBCXX__)
+			hash("libstdc++"), __GLIBCXX__, _GLIBCXX_USE_CXX11_ABI + 1,
+		#elif defined(_MSVC_STL_VERSION)
+			hash("msvc stl"), _MSVC_STL_VERSION, _ITERATOR_DEBUG_LEVEL + 1,
+		#else
+			0,
+		#endif
+		#if defined(_GLIBCXX_DEBUG)
+			hash("debug"),
+		#endif
+		};
+		std::uint64_t result{0xcbf29ce484222325};
+		for(const auto value : values) {
+			if(!value) return 0;
+			result = (result ^ value) * 0x100000001b3;
+		}
+		const auto folded{static_cast<std::uint32_t>(result ^ (result >> 32))};
+		return folded ? folded : 1;
+	}
+
+
+	struct feature final { //capabilities announced in the header
+		static
+		constexpr
+		std::uint8_t native_exceptions{1 << 0}; //exceptions derived from std::exception are forwarded as std::exception_ptr, only used if both sides share the same toolset
+
+		static
+		constexpr
+		std::uint8_t stateless{1 << 1}; //implementation is empty and trivial => instances need no storage and no calls to construct or destroy them
+
+		static
+		constexpr
+		std::uint8_t inline_storage{1 << 2}; //negotiated by the consumer: implementation fits into the storage reserved by the handle => constructed there instead of on the heap
+
+		static
+		constexpr
+		std::uint8_t all{native_exceptions | stateless | inline_storage}; //stored in the low bits of a dispatch
+
+		static
+		constexpr
+		std::uint8_t inline_layout{1 << 3}; //vtable contains the entries to destroy and relocate implementations stored in a handle, only checked while binding
+	};
+
+
+	template<typename T>
+	constexpr
+	bool stateless_v{std::is_empty_v<T> && std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>};
+
+	template<typename T>
+	constexpr
+	bool relocatable_v{!stateless_v<T> && std::is_nothrow_move_constructible_v<T>}; //may be stored in a handle, moved whenever the handle is moved
+
+
 	struct alignas(std::uint64_t) header final {
-		const version hversion{0}; //CWC header version
+		static
+		constexpr
+		version current{3}; //since hversion 3 vtable entries of noexcept methods return their result directly
+
+		static
+		constexpr
+		version minimum{3}; //vtables of older headers are laid out incompatibly => rejected
+
+		const version hversion{current}; //CWC header version
 		const std::uint8_t size{sizeof(header)};
 		version cversion; //component version
-		std::uint8_t reserved[5]{};
+		const std::uint8_t features; //since hversion 1
+		const std::uint32_t toolset{toolset_fingerprint()}; //since hversion 1
+		const std::uint32_t isize; //since hversion 2, size of the implementation, 0 => must not be stored in a handle
+		const std::uint32_t ialign; //since hversion 2, alignment of the implementation
+
+		constexpr
+		header(version cversion, bool stateless = false, bool inline_layout = false, std::uint32_t isize = 0, std::uint32_t ialign = 0) noexcept : cversion{cversion}, features{static_cast<std::uint8_t>(feature::native_exceptions | (stateless ? feature::stateless : 0) | (inline_layout ? feature::inline_layout : 0))}, isize{isize}, ialign{ialign} {}
 
+		template<typename T>
+		static
 		constexpr
-		header(version cversion) noexcept : cversion{cversion} {}
+		auto of(version cversion, bool inline_layout = false) noexcept -> header { return header{cversion, stateless_v<T>, inline_layout, relocatable_v<T> ? sizeof(T) : 0, relocatable_v<T> ? alignof(T) : 0}; }
 	};
-	static_assert(sizeof(header) == sizeof(std::uint64_t));
+	static_assert(sizeof(header) == 2 * sizeof(std::uint64_t));
 	static_assert(alignof(header) == alignof(std::uint64_t));
 	static_assert(offsetof(header, hversion) == 0);
 	static_assert(offsetof(header, size) == 1);
 	static_assert(offsetof(header, cversion) == 2);
+	static_assert(offsetof(header, features) == 3);
+	static_assert(offsetof(header, toolset) == 4);
+	static_assert(offsetof(header, isize) == 8);
+	static_assert(offsetof(header, ialign) == 12);
 
 
-	template<typename T>
-	struct access final {
-		template<typename Impl>
+	struct export_entry final { //defined by CWC_EXPORT_*
+		const char * name;
+		const char * library; //as passed to @library
+		const void * vtable;
+	};
+
+	struct exported final {
+		std::uint64_t hash; //of the mangled name
+		const export_entry * entry; //may be defined in any translation unit of the library
+	};
+
+	struct export_table final {
+		const exported * entries; //sorted by hash
+		std::size_t count;
+	};
+
+	template<std::size_t Size>
+	constexpr
+	auto sort_exports(std::array<exported, Size> entries) noexcept -> std::array<exported, Size> { //sorted at compile time => nothing to initialize when the library is loaded
+		for(std::size_t i{1}; i < Size; ++i) //TODO: [C++20] use std::sort
+			for(auto j{i}; j > 0 && entries[j].hash < entries[j - 1].hash; --j) {
+				const auto tmp{entries[j]};
+				entries[j] = entries[j - 1];
+				entries[j - 1] = tmp;
+			}
+		return entries;
+	}
+
+#ifdef CWC_STATIC_REGISTRY
+	struct export_registrar final { //links the export tables of all libraries of the executable
+		const export_table * table;
+		const export_registrar * next;
+
+		explicit
+		export_registrar(const export_table * table) noexcept : table{table}, next{std::exchange(list(), this)} {}
+
 		static
+		auto list() noexcept -> const export_registrar *& {
+			static const export_registrar * head{nullptr};
+			return head;
+		}
+	};
+#endif
+}
+
+//! @brief define the export table of a library
+//! @param ... @c cwc::internal::exported for every component the library exports, referring to the entries defined by the @c CWC_EXPORT_* macros
+//! @note prefer @c CWC_EXPORTS_* generated by cwcc for every library, e.g. @c CWC_EXPORTS_test_cwc(), which lists all components of the library
+//! @note must be used at global scope in exactly one translation unit of the library
+#ifdef CWC_STATIC_REGISTRY
+	#define CWC_EXPORTS(...) \
+		static constexpr auto cwc_export_entries{cwc::internal::sort_exports(std::array{__VA_ARGS__})}; \
+		static constexpr cwc::internal::export_table cwc_export_table{cwc_export_entries.data(), cwc_export_entries.size()}; \
+		static const cwc::internal::export_registrar cwc_export_registrar{&cwc_export_table}
+#else
+	extern "C" CWC_EXPORT auto cwc_exports() noexcept -> const cwc::internal::export_table *;
+
+	#define CWC_EXPORTS(...) \
+		static constexpr auto cwc_export_entries{cwc::internal::sort_exports(std::array{__VA_ARGS__})}; \
+		static constexpr cwc::internal::export_table cwc_export_table{cwc_export_entries.data(), cwc_export_entries.size()}; \
+		extern "C" CWC_EXPORT auto cwc_exports() noexcept -> const cwc::internal::export_table * { return &cwc_export_table; }
+#endif
+
+//! @brief define the warmup hook of a library
+//! @param cwc_func function without parameters, invoked after the library was loaded if load_policy::warmup is active
+//! @note the hook must not throw and must not use components of its own library
+//! @note with CWC_STATIC_REGISTRY there is nothing to load, hence the hook is never invoked
+#ifdef CWC_STATIC_REGISTRY
+	#define CWC_WARMUP(cwc_func) static_assert(noexcept(cwc_func()), "warmup hook must not throw")
+#else
+	#define CWC_WARMUP(cwc_func) \
+		static_assert(noexcept(cwc_func()), "warmup hook must not throw"); \
+		extern "C" CWC_EXPORT void cwc_warmup() noexcept { cwc_func(); }
+#endif
+
+//defining CWC_DIRECT_<mangled name> as the implementation type of a component before including its generated header binds all calls directly to that type
+//  => no library is loaded and exceptions are not mapped, the definition must be the same in every translation unit of a binary
+//  => unavailable for templated components
+
+namespace cwc {
+	//! @brief view of a contiguous sequence of elements, used by the batch methods generated for @c [[cwc::batch]]
+	//! @tparam T type of the elements
+	template<typename T>
+	class span final { //TODO: [C++20] replace with std::span
+		T * data_{nullptr};
+		std::size_t size_{0};
+	public:
+		constexpr
+		span() noexcept =default;
+		constexpr
+		span(T * data, std::size_t size) noexcept : data_{data}, size_{size} {}
+		template<typename Container, typename = std::enable_if_t<std::is_convertible_v<decltype(std::data(std::declval<Container &>())), T *>>>
 		constexpr
-		auto export_() { return T::template cwc_export<Impl>(); }
+		span(Container & container) noexcept : data_{std::data(container)}, size_{std::size(container)} {}
+		template<typename U, typename = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>>
+		constexpr
+		span(const span<U> & other) noexcept : data_{other.data()}, size_{other.size()} {}
 
-		static
-		auto available() noexcept -> bool {
-			try { T::cwc_context(); return true; }
-			catch(...) { return false; }
+		constexpr
+		auto data() const noexcept -> T * { return data_; }
+		constexpr
+		auto size() const noexcept -> std::size_t { return size_; }
+		constexpr
+		auto empty() const noexcept -> bool { return !size_; }
+
+		constexpr
+		auto begin() const noexcept -> T * { return data_; }
+		constexpr
+		auto end() const noexcept -> T * { return data_ + size_; }
+
+		constexpr
+		auto operator[](std::size_t index) const noexcept -> T & { return data_[index]; }
+	};
+
+
+	//! @brief exception that was caught at the ABI boundary, reported without rethrowing it
+	//! @note an exception forwarded as is keeps the library that threw it loaded until the error is destroyed, once rethrown until the process exits
+	class error final {
+	public:
+		error(std::uint64_t code, std::string what, std::exception_ptr native = nullptr, std::shared_ptr<const void> image = nullptr) : code_{code}, what_{std::move(what)} {
+			if(native) this->native.reset(new forwarded{std::move(image), std::move(native)}); //make_shared would emit a unique symbol, preventing libraries from being unloaded
+		}
+
+		//! @returns hierarchical type code of the caught exception, the most significant byte denotes the top-level type (e.g. @c 1 => std::exception, @c 2 => unknown_exception), every following byte a derived type
+		auto code() const noexcept -> std::uint64_t { return code_; }
+
+		//! @returns message of the caught exception
+		auto what() const noexcept -> const char * { return what_.c_str(); }
+
+		//! @brief throw the caught exception
+		//! @throws the original exception if both sides share the same toolset, otherwise the closest standard exception
+		//! @note on Haiku the library that threw can't be kept loaded, hence the closest standard exception is always thrown
+		[[noreturn]]
+		void rethrow() const;
+	private:
+		std::uint64_t code_;
+		std::string what_;
+		struct forwarded final {
+			std::shared_ptr<const void> image; //keeps the library that threw exception loaded, released after exception was destroyed
+			std::exception_ptr exception;
+		};
+		std::shared_ptr<const forwarded> native; //only set if both sides share the same toolset
+	};
+
+
+	//! @brief tag to construct an expected holding an error
+	struct unexpect_t final {
+		explicit
+		unexpect_t() =default;
+	};
+
+	//! @brief tag to construct an expected holding an error
+	inline
+	constexpr
+	unexpect_t unexpect{};
+
+	//! @brief either the result of a call or the error that occurred instead
+	//! @tparam T type of the result, may be void
+	//! @tparam E type of the error
+	template<typename T, typename E = error>
+	class expected final { //TODO: [C++23] replace with std::expected
+		static_assert(!std::is_reference_v<T>);
+
+		std::variant<T, E> content;
+
+		[[noreturn]]
+		void raise() const {
+			if constexpr(std::is_same_v<E, cwc::error>) std::get<1>(content).rethrow();
+			else throw std::get<1>(content);
+		}
+	public:
+		expected(T value) noexcept(std::is_nothrow_move_constructible_v<T>) : content{std::in_place_index<0>, std::move(value)} {}
+		expected(unexpect_t, E error) noexcept(std::is_nothrow_move_constructible_v<E>) : content{std::in_place_index<1>, std::move(error)} {}
+
+		//! @returns true iff the call succeeded
+		auto has_value() const noexcept -> bool { return content.index() == 0; }
+		explicit
+		operator bool() const noexcept { return has_value(); }
+
+		//! @pre has_value()
+		auto operator*() & noexcept -> T & { return *std::get_if<0>(&content); }
+		//! @pre has_value()
+		auto operator*() const & noexcept -> const T & { return *std::get_if<0>(&content); }
+		//! @pre has_value()
+		auto operator*() && noexcept -> T && { return std::move(*std::get_if<0>(&content)); }
+		//! @pre has_value()
+		auto operator->() noexcept -> T * { return std::get_if<0>(&content); }
+		//! @pre has_value()
+		auto operator->() const noexcept -> const T * { return std::get_if<0>(&content); }
+
+		//! @returns result of the call
+		//! @throws the error if the call failed, see error::rethrow
+		auto value() & -> T & {
+			if(!has_value()) raise();
+			return **this;
+		}
+		//! @returns result of the call
+		//! @throws the error if the call failed, see error::rethrow
+		auto value() const & -> const T & {
+			if(!has_value()) raise();
+			return **this;
 		}
+		//! @returns result of the call
+		//! @throws the error if the call failed, see error::rethrow
+		auto value() && -> T && {
+			if(!has_value()) raise();
+			return std::move(**this);
+		}
+
+		//! @pre !has_value()
+		auto error() const & noexcept -> const E & { return *std::get_if<1>(&content); }
+		//! @pre !has_value()
+		auto error() && noexcept -> E && { return std::move(*std::get_if<1>(&content)); }
 	};
 
+	//! @brief either the success of a call or the error that occurred instead
+	//! @tparam E type of the error
+	template<typename E>
+	class expected<void, E> final { //TODO: [C++23] replace with std::expected
+		std::optional<E> content; //empty => success
+	public:
+		expected() noexcept =default;
+		expected(unexpect_t, E error) noexcept(std::is_nothrow_move_constructible_v<E>) : content{std::move(error)} {}
+
+		//! @returns true iff the call succeeded
+		auto has_value() const noexcept -> bool { return !content; }
+		explicit
+		operator bool() const noexcept { return has_value(); }
+
+		//! @throws the error if the call failed, see error::rethrow
+		void value() const {
+			if(!content) return;
+			if constexpr(std::is_same_v<E, cwc::error>) content->rethrow();
+			else throw *content;
+		}
+
+		//! @pre !has_value()
+		auto error() const & noexcept -> const E & { return *content; }
+		//! @pre !has_value()
+		auto error() && noexcept -> E && { return std::move(*content); }
+	};
 
-	class exception final {
-		unsigned char buffer[128]; //TODO: determine size, can't fallback to heap as this operation may NEVER fail!
+
+	//! @brief allocation policy of @c CWC_EXPORT_*, every implementation is allocated individually via new and delete
+	//! @note used if no policy is passed
+	struct heap_allocation final {
+		template<typename T, typename... Args>
+		static
+		auto create(Args &&... args) -> T * { return new T(std::forward<Args>(args)...); }
+
+		template<typename T>
+		static
+		void destroy(T * ptr) noexcept { delete ptr; }
+	};
+
+	//! @brief occupancy of a pool backing a pool_allocation
+	struct pool_statistics final {
+		std::size_t live;      //!< blocks currently used by implementations
+		std::size_t cached;    //!< free blocks retained for reuse
+		std::size_t allocated; //!< blocks requested from the system
+		std::size_t released;  //!< blocks returned to the system
+	};
+}
+
+namespace cwc::internal {
+	auto retain(const void * address) noexcept -> std::shared_ptr<const void>; //keeps the library containing address loaded while referenced, nullptr => failed to pin it (always on Haiku)
+	auto retain_forever(const void * address) noexcept -> bool; //keeps the library containing address loaded until the process exits, false => failed to pin it (always on Haiku)
+
+
+	class exception final { //exception caught at the ABI boundary, its payload is stored in a buffer of the call context
 		struct vtable;
-		const vtable * vptr;
+		const vtable * vptr{nullptr}; //nullptr => nothing was caught
+		const bool native; //both sides share the same toolset => exceptions derived from std::exception are forwarded as std::exception_ptr
 
 		template<typename T>
-		void store(const T & exc) noexcept;
+		void store(unsigned char * buffer, const T & exc, bool forward = true) noexcept; //!forward => exc is not the exception currently being handled
+
+		void catch_(unsigned char * buffer) noexcept;
 
-		void catch_() noexcept;
+		[[noreturn]]
+		void rethrow(const unsigned char * buffer, const void * origin) const;
+
+		void destroy(unsigned char * buffer) noexcept;
 	public:
-		exception() noexcept;
+		static
+		constexpr
+		std::size_t size{128}; //TODO: determine size, can't fallback to heap as this operation may NEVER fail!
+
+		explicit
+		exception(bool native) noexcept : native{native} {}
 		exception(const exception &) =delete;
 		auto operator=(const exception &) -> exception & =delete;
-		~exception() noexcept;
 
 		template<typename Func>
-		void try_(Func func) noexcept
+		void try_(unsigned char * buffer, Func func) noexcept
 			try { func(); }
-			catch(...) { catch_(); }
+			catch(...) { catch_(buffer); }
+
+		void throw_(const unsigned char * buffer, const void * origin = nullptr) const { if(vptr) rethrow(buffer, origin); } //origin => address within the library that threw
+
+		auto caught() const noexcept -> bool { return vptr != nullptr; }
+
+		auto report(const unsigned char * buffer, const void * origin = nullptr) const -> error; //requires caught(), origin => address within the library that threw
 
-		void throw_() const;
+		static
+		auto current() -> error; //reports the exception currently being handled
+
+		void release(unsigned char * buffer) noexcept { if(vptr) destroy(buffer); } //must be called before the buffer is reused or destroyed
 	};
 
 
 	template<typename T>
-	class result final { //TODO: can this be merged with exception?
-		static_assert(!std::is_reference_v<T> && !std::is_pointer_v<T>);
+	constexpr
+	bool in_registers_v{std::is_trivially_copyable_v<T> && sizeof(T) <= 16}; //small enough to be returned in registers by common platform ABIs
+
+	template<typename T>
+	using returned_t = std::conditional_t<in_registers_v<T>, T, void>; //type returned by the vtable entry of a method that may throw
+
+
+	template<typename T>
+	constexpr
+	bool by_value_v{std::is_trivially_copyable_v<T> && sizeof(T) <= 2 * sizeof(void *)}; //cheaper to copy than to pass a pointer to the object of the caller
+
+	template<typename T>
+	using param_t = std::conditional_t<by_value_v<T>, T, T *>; //type of a by-value parameter in a vtable entry
+
+	template<typename T>
+	auto pass(T & param) noexcept -> param_t<T> { //caller: param must outlive the call
+		if constexpr(by_value_v<T>) return param;
+		else return std::addressof(param);
+	}
+
+	template<typename T>
+	auto take(param_t<T> & param) noexcept -> T && { //callee: the implementation move-constructs its parameter exactly once
+		if constexpr(by_value_v<T>) return std::move(param);
+		else return std::move(*param);
+	}
+
+
+	template<std::size_t Size, std::size_t Align, std::size_t HighWater, bool ReleaseToOS>
+	class pool final { //size class of a pool_allocation, free blocks are cached per thread shard before they are shared or released
+		static_assert(Size >= sizeof(void *) && Size % Align == 0);
+
+		struct block final { block * next; }; //overlays free blocks
+
+		struct alignas(64) list final { //shards don't share cache lines
+			std::atomic_flag locked = ATOMIC_FLAG_INIT; //critical sections only consist of a few instructions
+			block * head{nullptr};
+			std::size_t count{0}, acquired{0}, returned{0}; //blocks may be returned to a different shard
+		};
+
+		class guard final {
+			list & l;
+		public:
+			explicit
+			guard(list & l) noexcept : l{l} { while(l.locked.test_and_set(std::memory_order_acquire)); }
+			guard(const guard &) =delete;
+			auto operator=(const guard &) -> guard & =delete;
+			~guard() noexcept { l.locked.clear(std::memory_order_release); }
+		};
+
+		static
+		constexpr
+		std::size_t shards{8};
+
+		std::array<list, shards> caches;
+		list shared; //surplus of the caches, only used if !ReleaseToOS
+		std::atomic<std::size_t> allocated{0}, released{0}; //only touched if the caches are exhausted or full
+
+		auto cache() noexcept -> list & { //threads are assigned round robin, a thread_local cache would keep the library loaded until the thread exits
+			static std::atomic<std::size_t> next{0};
+			thread_local const auto index{next.fetch_add(1, std::memory_order_relaxed) % shards};
+			return caches[index];
+		}
 
-		unsigned char data[sizeof(T) + 1]{};
+		static
+		auto pop(list & l) noexcept -> void * {
+			const auto result{l.head};
+			if(result) {
+				l.head = result->next;
+				--l.count;
+			}
+			return result;
+		}
+
+		static
+		void push(list & l, void * ptr) noexcept {
+			l.head = ::new(ptr) block{l.head};
+			++l.count;
+		}
+
+		void release(list & l) noexcept {
+			while(const auto ptr{pop(l)}) {
+				::operator delete(ptr, std::align_val_t{Align});
+				released.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
 	public:
-		result() noexcept =default;
-		result(const result &) =delete;
-		auto operator=(const result &) -> result & =delete;
-		~result() noexcept { if(data[sizeof(T)]) reinterpret_cast<T *>(data)->~T(); }
+		pool() noexcept =default;
+		pool(const pool &) =delete;
+		auto operator=(const pool &) -> pool & =delete;
+		~pool() noexcept {
+			for(auto & c : caches) release(c);
+			release(shared);
+		}
+
+		CWC_LOCAL
+		static
+		auto instance() noexcept -> pool & { //hidden => every library has its own pools
+			static pool result;
+			return result;
+		}
+
+		auto allocate() -> void * {
+			auto & c{cache()};
+			{
+				const guard lock{c};
+				if(const auto result{pop(c)}) {
+					++c.acquired;
+					return result;
+				}
+			}
+			void * result{nullptr};
+			if constexpr(!ReleaseToOS) {
+				const guard lock{shared};
+				result = pop(shared);
+			}
+			if(!result) {
+				result = ::operator new(Size, std::align_val_t{Align});
+				allocated.fetch_add(1, std::memory_order_relaxed);
+			}
+			const guard lock{c};
+			++c.acquired;
+			return result;
+		}
 
-		void operator=(T && val) noexcept {
-			//TODO: assert(!data[sizeof(T)]);
-			new(data) T{std::move(val)};
-			data[sizeof(T)] = true;
+		void deallocate(void * ptr) noexcept {
+			auto & c{cache()};
+			{
+				const guard lock{c};
+				++c.returned;
+				if(c.count < HighWater) return push(c, ptr);
+			}
+			if constexpr(ReleaseToOS) {
+				::operator delete(ptr, std::align_val_t{Align});
+				released.fetch_add(1, std::memory_order_relaxed);
+			} else {
+				const guard lock{shared};
+				push(shared, ptr);
+			}
 		}
 
-		auto return_() noexcept -> T {
-			//TODO: assert(data[sizeof(T)]);
-			return std::move(*reinterpret_cast<T *>(data));
+		auto statistics() noexcept -> pool_statistics {
+			pool_statistics result{0, 0, allocated.load(std::memory_order_relaxed), released.load(std::memory_order_relaxed)};
+			std::size_t returned{0};
+			for(auto & c : caches) {
+				const guard lock{c};
+				result.live += c.acquired;
+				returned += c.returned;
+				result.cached += c.count;
+			}
+			result.live -= returned;
+			const guard lock{shared};
+			result.cached += shared.count;
+			return result;
 		}
 	};
 
+	template<typename T>
+	constexpr
+	std::size_t pool_align_v{std::max(alignof(T), alignof(std::max_align_t))};
+
+	template<typename T>
+	constexpr
+	std::size_t pool_size_v{(std::max(sizeof(T), sizeof(void *)) + pool_align_v<T> - 1) / pool_align_v<T> * pool_align_v<T>}; //implementations of similar size share a size class
+
+
+	template<typename T>
+	inline
+	T stateless_instance{}; //shared by all instances of a stateless implementation
+
+	template<typename T, typename Allocation = heap_allocation, typename... Args>
+	auto create(Args &&... args) -> void * {
+		if constexpr(stateless_v<T>) {
+			static_cast<void>(T(std::forward<Args>(args)...)); //constructors with parameters may still validate them
+			return &stateless_instance<T>;
+		} else return Allocation::template create<T>(std::forward<Args>(args)...);
+	}
+
+	template<typename T, typename Allocation = heap_allocation>
+	void destroy(void * self) noexcept { if constexpr(!stateless_v<T>) Allocation::destroy(static_cast<T *>(self)); }
+
+	template<typename T, typename Allocation = heap_allocation, typename... Args>
+	auto create_at(void * storage, Args &&... args) -> void * { //storage => reserved by the handle, the consumer already checked that the implementation fits
+		if constexpr(relocatable_v<T>)
+			if(storage) return ::new(storage) T(std::forward<Args>(args)...);
+		return create<T, Allocation>(std::forward<Args>(args)...);
+	}
+
+	template<typename T>
+	void destroy_at(void * self) noexcept { if constexpr(relocatable_v<T>) static_cast<T *>(self)->~T(); }
+
+	template<typename T>
+	void relocate(void * target, void * source) noexcept {
+		if constexpr(relocatable_v<T>) {
+			auto & impl{*static_cast<T *>(source)};
+			::new(target) T(std::move(impl));
+			impl.~T();
+		}
+	}
+
+	template<typename T>
+	auto self(std::conditional_t<std::is_const_v<T>, const void, void> * ptr) noexcept -> T * { //stateless implementations ignore the pointer, it may not refer to an instance
+		if constexpr(stateless_v<std::remove_const_t<T>>) return &stateless_instance<std::remove_const_t<T>>;
+		else return static_cast<T *>(ptr);
+	}
+
+
+	template<typename T, typename R>
+	void check_batch(span<const T> in, span<R> out) { //consumer: establishes the precondition of batch before crossing the ABI boundary
+		if(out.size() < in.size()) throw std::length_error{"cwc: batch has fewer results than parameters"};
+	}
+
+	template<typename Impl, typename T, typename R, typename Kernel, typename Scalar>
+	void batch(Impl & impl, span<const T> in, span<R> out, Kernel kernel, Scalar scalar) { //precondition: out.size() >= in.size(), elements before a failing one are already written
+		if constexpr(std::is_invocable_v<Kernel, Impl &, span<const T>, span<R>>) kernel(impl, in, out); //implementation provides a dedicated kernel, e.g. vectorized
+		else for(std::size_t i{0}; i < in.size(); ++i) out[i] = scalar(impl, in[i]);
+	}
+
 
 	//TODO: verify that returns always move...
 	template<typename T, bool Nothrow>
 	class call_context; //TODO: verify that all specializations are layouted portably...
 
 	template<typename T>
-	class call_context<T, false> final {
+	class call_context<T, false> final { //results of noexcept methods are returned directly
+		static_assert(!std::is_reference_v<T> && !std::is_pointer_v<T>);
+		static_assert(std::is_move_constructible_v<T>, "non-movable results are only supported for noexcept methods");
+
 		exception exc;
-		result<T> res;
+		bool engaged{false};
+		union {
+			T value;
+			alignas(std::max_align_t) unsigned char buffer[exception::size]; //only used if an exception was caught instead
+		};
 	public:
-		template<typename Func>
-		void try_(Func func) noexcept { exc.try_([&] { res = func(); }); }
-		auto return_() {
-			exc.throw_();
-			return res.return_();
+		explicit
+		call_context(bool native) noexcept : exc{native} {}
+		call_context(const call_context &) =delete;
+		auto operator=(const call_context &) -> call_context & =delete;
+		~call_context() noexcept {
+			if(engaged) value.~T();
+			else exc.release(buffer);
 		}
-	};
 
-	template<typename T>
-	class call_context<T, true> final {
-		result<T> res;
-	public:
 		template<typename Func>
-		void try_(Func func) noexcept { res = func(); }
-		auto return_() noexcept { return res.return_(); }
+		auto try_(Func func) noexcept -> returned_t<T> {
+			if constexpr(in_registers_v<T>) {
+				alignas(T) unsigned char result[sizeof(T)]; //trivially copyable => implicitly creates a T, no lifetime to track
+				exc.try_(buffer, [&] { new(result) T{func()}; });
+				if(exc.caught()) std::fill_n(result, sizeof(T), 0); //never observed, the exception is reported instead
+				return *std::launder(reinterpret_cast<const T *>(result));
+			} else exc.try_(buffer, [&] {
+				new(&value) T{func()};
+				engaged = true;
+			});
+		}
+
+		auto return_(const void * origin = nullptr) {
+			exc.throw_(buffer, origin);
+			if constexpr(!in_registers_v<T>) return std::move(value);
+		}
+
+		auto expect(const void * origin = nullptr) -> expected<T> { //result constructed in place
+			if(exc.caught()) return {unexpect, exc.report(buffer, origin)};
+			return std::move(value);
+		}
+
+		auto expect(T result, const void * origin = nullptr) -> expected<T> { //result returned in registers
+			if(exc.caught()) return {unexpect, exc.report(buffer, origin)};
+			return result;
+		}
 	};
 
 	template<>
 	class call_context<void, false> final {
 		exception exc;
+		alignas(std::max_align_t) unsigned char buffer[exception::size];
 	public:
+		explicit
+		call_context(bool native) noexcept : exc{native} {}
+		call_context(const call_context &) =delete;
+		auto operator=(const call_context &) -> call_context & =delete;
+		~call_context() noexcept { exc.release(buffer); }
+
 		template<typename Func>
-		void try_(Func func) noexcept { exc.try_(func); }
-		void return_() { exc.throw_(); }
+		void try_(Func func) noexcept { exc.try_(buffer, func); }
+		void return_(const void * origin = nullptr) { exc.throw_(buffer, origin); }
+
+		auto expect(const void * origin = nullptr) -> expected<void> {
+			if(exc.caught()) return {unexpect, exc.report(buffer, origin)};
+			return {};
+		}
 	};
 
 	template<>
 	struct call_context<void, true> final {
+		explicit
+		call_context(bool) noexcept {}
+
 		template<typename Func>
 		void try_(Func func) noexcept { func(); }
-		void return_() noexcept {}
+		void return_(const void * = nullptr) noexcept {}
 	};
 
 
@@ -158,8 +786,13 @@ namespace cwc::internal {
 	template<typename>
 	struct extract_call_context;
 
-	template<typename Class, typename... Args, typename T, bool N>
-	struct extract_call_context<void(* Class::*)(call_context<T, N> *, Args...) noexcept> {
+	template<typename Class, typename... Args, typename T>
+	struct extract_call_context<T(* Class::*)(Args...) noexcept> {
+		using type = void; //result is returned directly => constructed in the storage of the caller
+	};
+
+	template<typename Class, typename... Args, typename R, typename T, bool N>
+	struct extract_call_context<R(* Class::*)(call_context<T, N> *, Args...) noexcept> {
 		using type = call_context<T, N>;
 	};
 
@@ -167,25 +800,233 @@ namespace cwc::internal {
 	using extract_call_context_t = typename extract_call_context<T>::type;
 
 
-	class context final {
-		struct native_handle;
-		const std::unique_ptr<const native_handle> lib;
+	class dispatch final { //vtable and the features negotiated for it, cached by every instance => calls neither touch the context nor the binding
+		static_assert(feature::all < alignof(header)); //vtables directly follow the header
 
-		const void * vptr;
+		std::uintptr_t value{0}; //features are stored in the otherwise unused low bits
 	public:
-		context(const char * dll, const char * class_, version ver);
-		~context() noexcept;
+		dispatch() noexcept =default;
+		dispatch(const void * vptr, std::uint8_t features) noexcept : value{reinterpret_cast<std::uintptr_t>(vptr) | features} {}
+
+		explicit operator bool() const noexcept { return value; } //false => not bound to a vtable
+
+		auto stateless() const noexcept -> bool { return value & feature::stateless; }
+		auto inline_storage() const noexcept -> bool { return value & feature::inline_storage; }
 
 		template<auto VFunc, typename... Args>
 		auto call(Args &&... args) const {
 			using VFuncT = decltype(VFunc);
 			static_assert(std::is_member_object_pointer_v<VFuncT>);
-			const auto vtable{reinterpret_cast<const extract_vtable_t<VFuncT> *>(vptr)};
-			extract_call_context_t<VFuncT> ctx;
-			(vtable->*VFunc)(&ctx, std::forward<Args>(args)...);
-			return ctx.return_();
+			const auto vtable{reinterpret_cast<const extract_vtable_t<VFuncT> *>(value & ~std::uintptr_t{feature::all})};
+			if constexpr(std::is_void_v<extract_call_context_t<VFuncT>>) return (vtable->*VFunc)(std::forward<Args>(args)...); //guaranteed copy elision up to the caller
+			else {
+				extract_call_context_t<VFuncT> ctx{(value & feature::native_exceptions) != 0};
+				if constexpr(std::is_void_v<decltype((vtable->*VFunc)(&ctx, std::forward<Args>(args)...))>) {
+					(vtable->*VFunc)(&ctx, std::forward<Args>(args)...);
+					return ctx.return_(vtable); //rethrown exceptions may refer to the library of the vtable
+				} else { //returned in registers
+					const auto result{(vtable->*VFunc)(&ctx, std::forward<Args>(args)...)};
+					ctx.return_(vtable);
+					return result;
+				}
+			}
+		}
+
+		template<auto VFunc, typename... Args>
+		auto try_call(Args &&... args) const { //errors are reported instead of thrown
+			using VFuncT = decltype(VFunc);
+			static_assert(std::is_member_object_pointer_v<VFuncT>);
+			const auto vtable{reinterpret_cast<const extract_vtable_t<VFuncT> *>(value & ~std::uintptr_t{feature::all})};
+			extract_call_context_t<VFuncT> ctx{(value & feature::native_exceptions) != 0};
+			if constexpr(std::is_void_v<decltype((vtable->*VFunc)(&ctx, std::forward<Args>(args)...))>) {
+				(vtable->*VFunc)(&ctx, std::forward<Args>(args)...);
+				return ctx.expect(vtable); //forwarded exceptions may refer to the library of the vtable
+			} else return ctx.expect((vtable->*VFunc)(&ctx, std::forward<Args>(args)...), vtable); //returned in registers
+		}
+	};
+
+
+	class binding final { //vtable of a component within one loaded image of a library
+		friend class context;
+
+		std::atomic<dispatch> entry; //reset when the image is recycled, hence read by pin without holding the lock
+		std::atomic<std::size_t> * instances; //live instances of the image, image must not be unloaded while non-zero
+	public:
+		binding(const void * vptr, std::atomic<std::size_t> * instances, std::uint8_t features) noexcept : entry{dispatch{vptr, features}}, instances{instances} {}
+		binding(const binding &) =delete;
+		auto operator=(const binding &) -> binding & =delete;
+
+		auto vptr() const noexcept -> dispatch { return entry.load(std::memory_order_relaxed); } //stable while pinned
+
+		template<auto VFunc, typename... Args>
+		auto call(Args &&... args) const { return vptr().call<VFunc>(std::forward<Args>(args)...); }
+
+		template<auto VFunc, typename... Args>
+		auto try_call(Args &&... args) const { return vptr().try_call<VFunc>(std::forward<Args>(args)...); }
+
+		void unpin() const noexcept { instances->fetch_sub(1, std::memory_order_release); }
+	};
+
+
+	class context final {
+		struct image;
+		struct library;
+		library * lib; //shared between all contexts referring to the same library
+
+		mutable std::atomic<const binding *> current; //binding used for new instances, swapped when the library is reloaded
+		const char * const class_;
+		const version ver;
+		const std::size_t capacity; //bytes reserved for implementations by every handle
+
+		auto pin() const -> const binding *; //keeps the current image loaded while instances are alive
+	public:
+		context(const char * dll, const char * class_, version ver, std::size_t capacity = 0);
+		context(const context &) =delete;
+		auto operator=(const context &) -> context & =delete;
+		~context() noexcept;
+
+		static
+		void pin(const char * dll); //keeps library loaded until the end of the process
+
+		static
+		void swap(const char * dll, const std::filesystem::path & replacement); //loads replacement as new image of the library
+
+		static
+		auto probe(const char * dll, const char * class_, version ver, std::size_t capacity = 0) noexcept -> std::error_code; //never throws, failures are reported as cwc::errc
+
+		static
+		auto release_unused() noexcept -> std::size_t; //unloads images without instances
+
+		static
+		auto epoch() noexcept -> std::uint32_t; //incremented whenever cached probe results or memoized results become stale
+
+		static
+		auto identity() noexcept -> std::uint64_t; //unique for every call, keys memoized results of instances
+
+		template<auto VFunc, typename... Args>
+		auto construct(dispatch & vptr, void ** self, Args &&... args) const -> const binding * { return construct_at<VFunc>(vptr, self, nullptr, std::forward<Args>(args)...); }
+
+		template<auto VFunc, typename... Args>
+		auto construct_at(dispatch & vptr, void ** self, void * storage, Args &&... args) const -> const binding * { //storage => reserved by the handle, used if the implementation fits
+			const auto b{pin()};
+			if constexpr(sizeof...(Args) == 0) //default constructor => nothing to run for stateless implementations
+				if(b->vptr().stateless()) {
+					*self = const_cast<binding *>(b); //any non-null pointer marks the handle as engaged
+					vptr = b->vptr();
+					return b;
+				}
+			*self = b->vptr().inline_storage() ? storage : nullptr; //read by the constructor, nullptr => allocated on the heap
+			try { b->call<VFunc>(std::forward<Args>(args)..., self); }
+			catch(...) {
+				b->unpin();
+				throw;
+			}
+			vptr = b->vptr();
+			return b;
+		}
+
+		template<auto VFunc>
+		static
+		void destroy(const binding * b, void * self) noexcept {
+			if(!self) return; //moved-from instances don't keep the library loaded
+			if(!b->vptr().stateless()) b->call<VFunc>(self);
+			b->unpin();
+		}
+
+		template<auto VFunc, auto VFuncAt>
+		static
+		void destroy(const binding * b, void * self, const void * storage) noexcept { //VFuncAt => destroys implementations stored in the handle
+			if(self == storage) {
+				b->call<VFuncAt>(self);
+				b->unpin();
+			} else destroy<VFunc>(b, self);
+		}
+
+		template<auto VFunc, typename... Args>
+		auto call_static(Args &&... args) const {
+			const auto b{pin()};
+			const struct unpinner final {
+				const binding * b;
+				~unpinner() noexcept { b->unpin(); }
+			} guard{b};
+			return b->call<VFunc>(std::forward<Args>(args)...);
+		}
+
+		template<auto VFunc, typename... Args>
+		auto try_call_static(Args &&... args) const { //failures to load the library are still thrown
+			const auto b{pin()};
+			const struct unpinner final {
+				const binding * b;
+				~unpinner() noexcept { b->unpin(); }
+			} guard{b};
+			return b->try_call<VFunc>(std::forward<Args>(args)...);
+		}
+	};
+
+	template<typename R, typename... Args>
+	class memo final { //bounded cache of the results of a pure method, evicts the least recently used result
+		static_assert(std::is_copy_constructible_v<R>, "results of pure methods must be copyable");
+
+		struct entry final {
+			std::tuple<Args...> args;
+			R result;
+		};
+		std::vector<entry> entries; //least recently used first, searched linearly as capacities are small
+		const std::size_t capacity;
+		std::uint32_t epoch{0};
+	public:
+		explicit
+		memo(std::size_t capacity = 16) noexcept : capacity{capacity} {}
+
+		template<typename Func>
+		auto get(Func func, const Args &... args) -> R {
+			if(const auto current{context::epoch()}; current != epoch) { //libraries may have been replaced
+				entries.clear();
+				epoch = current;
+			}
+			if(const auto it{std::find_if(entries.begin(), entries.end(), [&](const entry & e) { return e.args == std::tie(args...); })}; it != entries.end()) {
+				std::rotate(it, it + 1, entries.end());
+				return entries.back().result;
+			}
+			std::tuple<Args...> key{args...}; //func may move from args
+			R result{func()};
+			if(entries.size() == capacity) entries.erase(entries.begin());
+			entries.push_back(entry{std::move(key), result});
+			return result;
 		}
 	};
+
+	auto category() noexcept -> const std::error_category &;
+
+
+	template<typename T>
+	struct access final {
+		template<typename Impl, typename Allocation = heap_allocation>
+		static
+		constexpr
+		auto export_() { return T::template cwc_export<Impl, Allocation>(); }
+
+		static
+		auto probe() noexcept -> std::error_code {
+			static std::atomic<std::uint64_t> cache{0}; //epoch of the probe in the upper half, error value in the lower half
+			const std::uint64_t epoch{context::epoch()};
+			if(const auto value{cache.load(std::memory_order_relaxed)}; value >> 32 == epoch) return value & 0xFFFFFFFF ? std::error_code{static_cast<int>(value & 0xFFFFFFFF), category()} : std::error_code{};
+			const auto result{T::cwc_probe()};
+			if(!result || result.category() == category()) cache.store(epoch << 32 | static_cast<std::uint32_t>(result.value()), std::memory_order_relaxed); //don't cache transient failures like exhausted resources
+			return result;
+		}
+
+		static
+		void load(const char *) { T::cwc_context(); }
+	};
+
+
+	struct preload_task final {
+		void(*func)(const char *);
+		const char * arg;
+	};
+
+	void preload(const preload_task * tasks, std::size_t count);
 }
 
 
@@ -197,10 +1038,205 @@ namespace cwc {
 	};
 
 
+	//! @brief reasons why a component is unavailable
+	enum class errc {
+		library_not_found = 1, //!< library was not found in any search path
+		library_not_loadable,  //!< library was found but could not be loaded
+		entry_point_not_found, //!< library does not export the component
+		version_mismatch,      //!< library exports an outdated version of the component
+		incompatible_layout    //!< library was built against an unsupported binary layout of components
+	};
+
+	//! @brief create error code in the CWC error category
+	//! @param[in] e error to wrap
+	//! @returns error code representing @p e
+	inline
+	auto make_error_code(errc e) noexcept -> std::error_code { return {static_cast<int>(e), internal::category()}; }
+
+
+	//! @brief check why type is unavailable
+	//! @tparam T type to check availability for
+	//! @returns empty error code iff the component is available, otherwise the reason why it is not (usually a cwc::errc)
+	//! @note unless the component is already loaded before, this operation tries to implicitly load it
+	//! @note results are cached until the next call to refresh, search_paths or load_manifest, repeated probes neither load libraries nor throw exceptions
+	template<typename T>
+	auto probe() noexcept -> std::error_code { return internal::access<T>::probe(); }
+
 	//! @brief check that type is available
 	//! @tparam T type to check availability for
 	//! @returns true iff the component is available
 	//! @note unless the component is already loaded before, this operation tries to implicitly load it
 	template<typename T>
-	auto available() noexcept -> bool { return internal::access<T>::available(); }
+	auto available() noexcept -> bool { return !probe<T>(); }
+
+	//! @brief unload all libraries without live component instances
+	//! @returns number of unloaded libraries
+	//! @note libraries are transparently reloaded once one of their components is instantiated again, libraries preloaded by name remain loaded
+	auto release_unused() noexcept -> std::size_t;
+
+	//! @brief replace a library with a new build without interrupting its users
+	//! @param[in] library name of the library to replace, using the same format as @c \@library
+	//! @param[in] replacement new build of the library, relative paths are resolved against the directory of the executable
+	//! @throws std::system_error if the replacement could not be loaded or does not provide all components that are in use
+	//! @note existing instances and calls in flight keep using the previous build, which is unloaded by release_unused once its last instance is destroyed
+	//! @note new instances are created by the replacement, the library must not be replaced in place as loaders return the already loaded build for the same path
+	void hot_swap(const char * library, const std::filesystem::path & replacement);
+
+	//! @brief discard cached results of failed lookups
+	//! @note use after installing libraries at runtime, otherwise components that were unavailable before will remain so
+	void refresh() noexcept;
+
+
+	//! @brief exception thrown when at least one component or library could not be preloaded
+	class preload_error final : public std::runtime_error {
+	public:
+		//! @brief failure to load a single component or library
+		struct failure final {
+			std::size_t index; //!< position of the failed component or library in the preload request
+			std::exception_ptr error; //!< error that occurred while loading
+		};
+
+		explicit
+		preload_error(std::vector<failure> failures);
+
+		//! @returns all failures that occurred during preloading, ordered by index
+		auto failures() const noexcept -> const std::vector<failure> & { return failures_; }
+	private:
+		std::vector<failure> failures_;
+	};
+
+
+	//! @brief eagerly load components
+	//! @tparam Components components to load
+	//! @throws preload_error if any of the components could not be loaded
+	//! @note independent libraries are loaded concurrently, components that failed to load will be retried on first use
+	//! @note libraries are not kept loaded, release_unused unloads them while no component instances are alive
+	template<typename... Components>
+	void preload() {
+		const std::array<internal::preload_task, sizeof...(Components)> tasks{{{internal::access<Components>::load, nullptr}...}};
+		internal::preload(tasks.data(), tasks.size());
+	}
+
+	//! @brief eagerly load libraries and keep them loaded until the end of the process
+	//! @param[in] libraries names of the libraries to load, using the same format as @c \@library
+	//! @throws preload_error if any of the libraries could not be loaded
+	//! @note libraries are loaded concurrently
+	void preload(std::initializer_list<const char *> libraries);
+
+	//! @brief asynchronously and eagerly load components
+	//! @tparam Components components to load
+	//! @returns future that becomes ready once all components are loaded, stores preload_error if any of them could not be loaded
+	template<typename... Components>
+	auto preload_async() -> std::future<void> { return std::async(std::launch::async, [] { preload<Components...>(); }); }
+
+	//! @brief asynchronously and eagerly load libraries and keep them loaded until the end of the process
+	//! @param[in] libraries names of the libraries to load, must remain valid until the returned future becomes ready
+	//! @returns future that becomes ready once all libraries are loaded, stores preload_error if any of them could not be loaded
+	auto preload_async(std::initializer_list<const char *> libraries) -> std::future<void>;
+
+
+	//! @brief set directories that are searched for libraries
+	//! @param[in] paths directories to probe in order, relative paths are resolved against the directory of the executable
+	//! @note defaults to only the directory of the executable, libraries that are already loaded are not affected
+	void search_paths(std::vector<std::filesystem::path> paths);
+
+	//! @brief measures taken whenever a library is loaded
+	enum class load_policy : unsigned {
+		lazy     = 0,      //!< pages are faulted in on first use
+		prefault = 1 << 0, //!< fault in all mapped segments of the library
+		lock     = 1 << 1, //!< lock all mapped segments of the library into memory (best effort, subject to OS limits), implies prefault
+		warmup   = 1 << 2  //!< invoke the hook defined via CWC_WARMUP
+	};
+
+	constexpr
+	auto operator|(load_policy lhs, load_policy rhs) noexcept -> load_policy { return static_cast<load_policy>(static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs)); }
+
+	constexpr
+	auto operator&(load_policy lhs, load_policy rhs) noexcept -> load_policy { return static_cast<load_policy>(static_cast<unsigned>(lhs) & static_cast<unsigned>(rhs)); }
+
+	//! @brief set policy for loading libraries
+	//! @param[in] policy measures applied to every library that is loaded from now on
+	//! @note intended to move page faults and cache initialization of latency critical components from their first calls to load time
+	void set_load_policy(load_policy policy) noexcept;
+
+	//! @brief set variants of libraries that are preferred over their baseline build
+	//! @param[in] variants suffixes in order of preference, a library @c name with variant @c v is looked up as e.g. @c libname.v.so
+	//! @note defaults to the x86-64 microarchitecture levels supported by the CPU (e.g. @c x86-64-v3), starting with the best one
+	//! @note variants are only detected on x86-64, other architectures default to no variants but may still set them explicitly
+	//! @note every search path is probed for all variants before falling back to the baseline build, libraries that are already loaded are not affected
+	void library_variants(std::vector<std::string> variants);
+
+	//! @returns variants of libraries that are preferred over their baseline build
+	auto library_variants() -> std::vector<std::string>;
+
+	//! @brief load a manifest mapping components to libraries and versions
+	//! @param[in] file manifest to load, relative paths are resolved against the directory of the executable
+	//! @throws std::runtime_error if the manifest could not be opened
+	//! @throws std::invalid_argument if the manifest is malformed
+	//! @note components listed in a manifest are loaded directly from the listed library without probing any search path, libraries are resolved relative to the manifest
+	//! @note the same holds for libraries listed in a manifest, e.g. when preloading or swapping them
+	//! @note entries of manifests loaded later take precedence
+	//! @note manifests are generated by invoking CWCC with @c --manifest
+	void load_manifest(const std::filesystem::path & file);
+
+
+	//! @brief enable or disable recording of load statistics
+	//! @param[in] enable true iff loading of libraries and components should be recorded from now on
+	//! @note recording is disabled by default, disabled recording incurs no measurable overhead
+	void record_load_statistics(bool enable) noexcept;
+
+	//! @brief format of load reports
+	enum class report_format {
+		text, //!< human-readable table
+		json  //!< machine-readable JSON document
+	};
+
+	//! @brief write report of all recorded load statistics
+	//! @param[out] os stream to write report to
+	//! @param[in] format format of the report
+	//! @note the report contains load time and mapped size per library, as well as lookup time and version check result per component
+	void load_report(std::ostream & os, report_format format = report_format::text);
+
+
+	//! @brief allocation policy of @c CWC_EXPORT_*, recycles the storage of destroyed implementations via a thread-caching object pool
+	//! @tparam HighWater maximum number of free blocks retained by each thread cache
+	//! @tparam ReleaseToOS true iff free blocks beyond @p HighWater are returned to the system, otherwise they are retained for all threads
+	//! @note pass as second argument, e.g. @c CWC_EXPORT_3foo3bar(impl, cwc::pool_allocation<>)
+	//! @note implementations of the same size class share a pool, every library has its own pools
+	template<std::size_t HighWater = 64, bool ReleaseToOS = true>
+	struct pool_allocation final {
+		template<typename T, typename... Args>
+		static
+		auto create(Args &&... args) -> T * {
+			auto & p{pool_t<T>::instance()};
+			const auto ptr{p.allocate()};
+			try { return ::new(ptr) T(std::forward<Args>(args)...); }
+			catch(...) {
+				p.deallocate(ptr);
+				throw;
+			}
+		}
+
+		template<typename T>
+		static
+		void destroy(T * ptr) noexcept {
+			ptr->~T();
+			pool_t<T>::instance().deallocate(ptr);
+		}
+
+		//! @tparam T implementation
+		//! @returns occupancy of the pool backing @p T in the calling library
+		template<typename T>
+		static
+		auto statistics() noexcept -> pool_statistics { return pool_t<T>::instance().statistics(); }
+	private:
+		template<typename T>
+		using pool_t = internal::pool<internal::pool_size_v<T>, internal::pool_align_v<T>, HighWater, ReleaseToOS>;
+	};
+}
+
+
+namespace std {
+	template<>
+	struct is_error_code_enum<cwc::errc> : true_type {};
 }
@@ -7,6 +7,8 @@
 #include "fibonacci.cwch"
 
 #ifndef CWC_SAMPLE_DLL
+#include <array>
+#include <numeric>
 #include <iomanip>
 #include <iostream>
 
@@ -17,7 +19,12 @@ int main() try {
 
 	std::cout << "\n\n\n";
 
-	for(std::uint8_t i{0}; i < 94; ++i) std::cout << "fibonacci(" << std::setw(2) << static_cast<int>(i) << ") = " << std::right << std::setw(20) << s.calculate(i) << '\n';
+	std::array<std::uint8_t, 94> nos;
+	std::iota(nos.begin(), nos.end(), std::uint8_t{0});
+	std::array<std::uint64_t, nos.size()> results;
+	s.calculate(nos, results); //single call into the library
+
+	for(std::size_t i{0}; i < nos.size(); ++i) std::cout << "fibonacci(" << std::setw(2) << static_cast<int>(nos[i]) << ") = " << std::right << std::setw(20) << results[i] << '\n';
 
 	std::cout << "\n\n\n";
 
@@ -57,4 +64,5 @@ namespace {
 }
 
 CWC_EXPORT_3cwc6sample9fibonacci8sequenceT3std7uint8_t_1E(fibonacci_sequence);
+CWC_EXPORTS_sample_fibonacci();
 #endif
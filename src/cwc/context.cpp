@@ -4,10 +4,31 @@
 //    (See accompanying file ../../LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <cstring>
+#include <list>
 #include <string>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 #include <stdexcept>
 #include <algorithm>
 #include <filesystem>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifndef _WIN32
+	namespace {
+		__attribute__((no_sanitize("address"))) //pages extend beyond the globals known to the sanitizer
+		void touch(const char * first, const char * last, std::size_t page) noexcept { for(auto p{first}; p < last; p += page) static_cast<void>(*static_cast<const volatile char *>(p)); }
+	}
+#endif
 
 #ifdef _WIN32
 	#define UNICODE
@@ -20,6 +41,7 @@
 		#define NOMINMAX
 	#endif
 	#include <Windows.h>
+	#include <Psapi.h>
 
 	namespace {
 		using handle = HMODULE;
@@ -35,12 +57,27 @@
 			}
 		}
 
+		auto mapped_size(handle lib) noexcept -> std::size_t {
+			MODULEINFO info;
+			return GetModuleInformation(GetCurrentProcess(), lib, &info, sizeof(info)) ? info.SizeOfImage : 0;
+		}
+
+		void prefault(handle lib, bool lock) noexcept {
+			MODULEINFO info;
+			if(!GetModuleInformation(GetCurrentProcess(), lib, &info, sizeof(info))) return;
+			WIN32_MEMORY_RANGE_ENTRY range{info.lpBaseOfDll, info.SizeOfImage};
+			PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+			if(lock) VirtualLock(info.lpBaseOfDll, info.SizeOfImage);
+		}
+
 		constexpr
 		std::string_view dll_prefix{""}, dll_suffix{".dll"};
 	}
 #elif __linux__
+	#include <link.h>
 	#include <dlfcn.h>
 	#include <unistd.h>
+	#include <sys/mman.h>
 	#include <linux/limits.h>
 
 	#define LoadLibrary(file) dlopen(file, RTLD_NOW)
@@ -60,6 +97,45 @@
 			}
 		}
 
+		auto mapped_size(handle lib) noexcept -> std::size_t {
+			link_map * map;
+			if(dlinfo(lib, RTLD_DI_LINKMAP, &map) != 0) return 0;
+			std::pair<ElfW(Addr), std::size_t> result{map->l_addr, 0};
+			dl_iterate_phdr([](dl_phdr_info * info, std::size_t, void * param) {
+				auto & [addr, size]{*reinterpret_cast<decltype(result) *>(param)};
+				if(info->dlpi_addr != addr) return 0;
+				for(ElfW(Half) i{0}; i < info->dlpi_phnum; ++i)
+					if(info->dlpi_phdr[i].p_type == PT_LOAD) size += info->dlpi_phdr[i].p_memsz;
+				return 1;
+			}, &result);
+			return result.second;
+		}
+
+		void prefault(handle lib, bool lock) noexcept {
+			link_map * map;
+			if(dlinfo(lib, RTLD_DI_LINKMAP, &map) != 0) return;
+			std::pair<ElfW(Addr), bool> request{map->l_addr, lock};
+			dl_iterate_phdr([](dl_phdr_info * info, std::size_t, void * param) {
+				const auto & [addr, lock]{*reinterpret_cast<decltype(request) *>(param)};
+				if(info->dlpi_addr != addr) return 0;
+				const auto page{static_cast<ElfW(Addr)>(sysconf(_SC_PAGESIZE))};
+				for(ElfW(Half) i{0}; i < info->dlpi_phnum; ++i) {
+					const auto & segment{info->dlpi_phdr[i]};
+					if(segment.p_type != PT_LOAD || !(segment.p_flags & PF_R)) continue;
+					const auto first{(addr + segment.p_vaddr) & ~(page - 1)}, last{addr + segment.p_vaddr + segment.p_memsz};
+				#ifdef MADV_POPULATE_READ
+					if(madvise(reinterpret_cast<void *>(first), last - first, MADV_POPULATE_READ) != 0) //unsupported before Linux 5.14
+				#endif
+					{
+						madvise(reinterpret_cast<void *>(first), last - first, MADV_WILLNEED);
+						touch(reinterpret_cast<const char *>(first), reinterpret_cast<const char *>(last), page); //read-ahead is only a hint
+					}
+					if(lock) mlock(reinterpret_cast<void *>(first), last - first);
+				}
+				return 1;
+			}, &request);
+		}
+
 		constexpr
 		std::string_view dll_prefix{"lib"}, dll_suffix{".so"};
 	}
@@ -67,6 +143,8 @@
 	#include <dlfcn.h>
 	#include <unistd.h>
 	#include <libproc.h>
+	#include <sys/mman.h>
+	#include <mach-o/loader.h>
 
 	#define LoadLibrary(file) dlopen(file, RTLD_NOW)
 	#define GetProcAddress(dll, function) dlsym(dll, function)
@@ -82,6 +160,42 @@
 			return tmp;
 		}
 
+		template<typename Func>
+		void segments(handle lib, Func func) noexcept { //invokes func(first, last) for every readable segment of lib
+			Dl_info info;
+			const auto symbol{dlsym(lib, "cwc_exports")}; //exported by every library that was loaded successfully
+			if(!symbol || !dladdr(symbol, &info)) return;
+			const auto header{static_cast<const mach_header_64 *>(info.dli_fbase)};
+			const auto next{[](const load_command * cmd) { return reinterpret_cast<const load_command *>(reinterpret_cast<const char *>(cmd) + cmd->cmdsize); }};
+			std::intptr_t slide{0};
+			auto cmd{reinterpret_cast<const load_command *>(header + 1)};
+			for(std::uint32_t i{0}; i < header->ncmds; ++i, cmd = next(cmd))
+				if(cmd->cmd == LC_SEGMENT_64 && std::strcmp(reinterpret_cast<const segment_command_64 *>(cmd)->segname, SEG_TEXT) == 0)
+					slide = reinterpret_cast<std::intptr_t>(header) - static_cast<std::intptr_t>(reinterpret_cast<const segment_command_64 *>(cmd)->vmaddr);
+			cmd = reinterpret_cast<const load_command *>(header + 1);
+			for(std::uint32_t i{0}; i < header->ncmds; ++i, cmd = next(cmd)) {
+				if(cmd->cmd != LC_SEGMENT_64) continue;
+				const auto segment{reinterpret_cast<const segment_command_64 *>(cmd)};
+				if(!segment->vmsize || !(segment->initprot & VM_PROT_READ)) continue; //e.g. __PAGEZERO
+				const auto first{reinterpret_cast<const char *>(segment->vmaddr + slide)};
+				func(first, first + segment->vmsize);
+			}
+		}
+
+		auto mapped_size(handle lib) noexcept -> std::size_t {
+			std::size_t result{0};
+			segments(lib, [&](const char * first, const char * last) { result += last - first; });
+			return result;
+		}
+
+		void prefault(handle lib, bool lock) noexcept {
+			segments(lib, [&](const char * first, const char * last) {
+				madvise(const_cast<char *>(first), last - first, MADV_WILLNEED);
+				touch(first, last, static_cast<std::size_t>(getpagesize())); //read-ahead is only a hint
+				if(lock) mlock(first, last - first);
+			});
+		}
+
 		constexpr
 		std::string_view dll_prefix{"lib"}, dll_suffix{".dylib"};
 	}
@@ -89,10 +203,11 @@
 	
 #elif defined(__HAIKU__)
 	#include <image.h>
+	#include <sys/mman.h>
 	#define LoadLibrary(file) std::max(load_add_on(file), image_id{0})
 	#define GetProcAddress(dll, function) [&] {\
 		void * result{nullptr};\
-		get_image_symbol(dll, function, B_SYMBOL_TYPE_DATA, &result);\
+		get_image_symbol(dll, function, B_SYMBOL_TYPE_ANY, &result);\
 		return result;\
 	}()
 	#define FreeLibrary(dll) unload_add_on(dll)
@@ -108,6 +223,20 @@
 			return info.name;
 		}
 
+		auto mapped_size(handle lib) noexcept -> std::size_t {
+			image_info info;
+			return get_image_info(lib, &info) == B_OK ? static_cast<std::size_t>(info.text_size + info.data_size) : 0;
+		}
+
+		void prefault(handle lib, bool lock) noexcept {
+			image_info info;
+			if(get_image_info(lib, &info) != B_OK) return;
+			for(const auto & [first, size] : {std::pair{static_cast<const char *>(info.text), info.text_size}, std::pair{static_cast<const char *>(info.data), info.data_size}}) {
+				touch(first, first + size, B_PAGE_SIZE);
+				if(lock) mlock(first, size);
+			}
+		}
+
 		constexpr
 		std::string_view dll_prefix{"lib"}, dll_suffix{".so"};
 	}
@@ -115,51 +244,663 @@
 	#error unknown operating system
 #endif
 
+#if defined(__x86_64__) || defined(_M_X64)
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+
+	namespace {
+		auto cpu_variants() -> std::vector<std::string> { //x86-64 microarchitecture levels as defined by the psABI, best one first
+			const auto cpuid{[](unsigned leaf, unsigned subleaf) {
+				std::array<unsigned, 4> regs{}; //eax, ebx, ecx, edx
+			#ifdef _MSC_VER
+				__cpuidex(reinterpret_cast<int *>(regs.data()), static_cast<int>(leaf), static_cast<int>(subleaf));
+			#else
+				__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+			#endif
+				return regs;
+			}};
+			const auto bits{[](unsigned reg, std::initializer_list<int> positions) { return std::all_of(positions.begin(), positions.end(), [&](int pos) { return reg >> pos & 1; }); }};
+
+			const auto max_leaf{cpuid(0, 0)[0]}, max_extended_leaf{cpuid(0x80000000, 0)[0]};
+			if(max_leaf < 7 || max_extended_leaf < 0x80000001) return {};
+			const auto leaf1{cpuid(1, 0)}, leaf7{cpuid(7, 0)}, extended{cpuid(0x80000001, 0)};
+
+			const auto v2{bits(leaf1[2], {0, 9, 13, 19, 20, 23}) && bits(extended[2], {0})}; //sse3, ssse3, cx16, sse4.1, sse4.2, popcnt, lahf
+			if(!v2) return {};
+
+			const auto xcr0{[&]() -> std::uint64_t {
+				if(!bits(leaf1[2], {27})) return 0; //OS has not enabled xsave
+			#ifdef _MSC_VER
+				return _xgetbv(0);
+			#else
+				unsigned eax, edx;
+				__asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+				return static_cast<std::uint64_t>(edx) << 32 | eax;
+			#endif
+			}()};
+			const auto v3{bits(leaf1[2], {12, 22, 26, 28, 29}) && bits(leaf7[1], {3, 5, 8}) && bits(extended[2], {5}) && (xcr0 & 0x06) == 0x06}; //fma, movbe, xsave, avx, f16c, bmi1, avx2, bmi2, lzcnt + OS support for avx
+			if(!v3) return {"x86-64-v2"};
+
+			const auto v4{bits(leaf7[1], {16, 17, 28, 30, 31}) && (xcr0 & 0xE0) == 0xE0}; //avx512f, avx512dq, avx512cd, avx512bw, avx512vl + OS support for avx512
+			if(!v4) return {"x86-64-v3", "x86-64-v2"};
+			return {"x86-64-v4", "x86-64-v3", "x86-64-v2"};
+		}
+	}
+#else
+	namespace {
+		auto cpu_variants() -> std::vector<std::string> { return {}; } //no detected variants for other architectures (yet), only baseline builds are loaded unless set explicitly
+	}
+#endif
+
 #include <cwc/cwc.hpp>
 
 namespace cwc::internal {
 	namespace {
 		const auto base_path{executable_name().remove_filename()};
+
+		using key = std::filesystem::path::string_type;
+
+		auto library_path(const std::filesystem::path & directory, std::string_view dll, std::string_view variant = {}) -> std::filesystem::path {
+			auto fullpath{base_path / directory};
+			const auto pos{dll.rfind('/')};
+			if(pos != std::string_view::npos) fullpath /= dll.substr(0, pos + 1);
+			fullpath /= dll_prefix;
+			fullpath += dll.substr(pos + 1);
+			if(!variant.empty()) {
+				fullpath += '.';
+				fullpath += variant;
+			}
+			fullpath += dll_suffix;
+			return fullpath.lexically_normal();
+		}
+
+
+		using clock = std::chrono::steady_clock;
+
+		struct library_record final {
+			std::string name, path;
+			clock::duration load;
+			std::size_t mapped;
+			const char * status;
+		};
+
+		struct component_record final {
+			std::string name, library;
+			clock::duration lookup;
+			version required, provided;
+			const char * status;
+		};
+
+		struct statistics_t final {
+			std::atomic<bool> enabled{false};
+			std::mutex mutex;
+			std::vector<library_record> libraries;
+			std::vector<component_record> components;
+		};
+
+		auto statistics() -> statistics_t & {
+			static statistics_t instance;
+			return instance;
+		}
+
+		auto recording() noexcept -> bool { return statistics().enabled.load(std::memory_order_relaxed); }
+
+		template<typename Record>
+		void record(std::vector<Record> statistics_t::* records, Record && r) noexcept try {
+			auto & s{statistics()};
+			const std::lock_guard lock{s.mutex};
+			(s.*records).push_back(std::move(r));
+		} catch(...) {} //statistics are best effort and must never affect loading
+
+		template<typename Rep, typename Period>
+		auto microseconds(std::chrono::duration<Rep, Period> d) noexcept { return std::chrono::duration<double, std::micro>{d}.count(); }
+
+		void write_json(std::ostream & os, std::string_view str) {
+			os << '"';
+			for(const auto c : str)
+				switch(c) {
+					case '"': os << "\\\""; break;
+					case '\\': os << "\\\\"; break;
+					default:
+						if(static_cast<unsigned char>(c) < 0x20) os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+						else os << c;
+				}
+			os << '"';
+		}
+
+
+		std::atomic<load_policy> policy{load_policy::lazy};
+
+		std::atomic<std::uint32_t> probe_epoch{1}; //0 is reserved for "never probed"
+
+		struct locator_t final {
+			std::mutex mutex;
+			std::vector<std::filesystem::path> search_paths{{}}; //relative to base_path
+			std::unordered_map<std::string, key> paths; //cache of probed paths per library, empty if library was not found
+			std::unordered_set<key> unloadable; //cache of libraries that failed to load
+			std::vector<std::string> variants{cpu_variants()}; //preferred over the baseline build, best one first
+			std::unordered_map<std::string, std::pair<version, key>> manifest; //version and path per component
+			std::unordered_map<std::string, key> manifest_libraries; //path per library listed in a manifest, used for components that are not listed themselves (e.g. preloading)
+
+			auto locate(const char * dll, const char * class_, version ver, errc & ec) -> key { //TODO: [C++20] use heterogeneous lookup
+				const std::lock_guard lock{mutex};
+				const auto result{[&]() -> const key * {
+					if(const auto it{manifest.find(class_)}; it != manifest.end()) {
+						const auto & [provided, path]{it->second};
+						if(provided < ver) {
+							ec = errc::version_mismatch;
+							return nullptr;
+						}
+						return &path;
+					}
+					if(const auto it{manifest_libraries.find(dll)}; it != manifest_libraries.end()) return &it->second;
+
+					const auto [it, inserted]{paths.try_emplace(dll)};
+					if(inserted) {
+						const auto probe{[&](const std::filesystem::path & directory, std::string_view variant) {
+							auto fullpath{library_path(directory, dll, variant)};
+							if(!std::filesystem::exists(fullpath)) return false; //probing the filesystem is way cheaper than a failing load
+							it->second = std::move(fullpath).native();
+							return true;
+						}};
+						for(const auto & directory : search_paths)
+							if(std::any_of(variants.begin(), variants.end(), [&](const auto & v) { return probe(directory, v); }) || probe(directory, {})) break;
+						if(it->second.empty() && recording()) record(&statistics_t::libraries, library_record{dll, {}, {}, 0, "not found"});
+					}
+					if(it->second.empty()) {
+						ec = errc::library_not_found;
+						return nullptr;
+					}
+					return &it->second;
+				}()};
+				if(!result) return {};
+				if(unloadable.count(*result)) {
+					ec = errc::library_not_loadable;
+					return {};
+				}
+				return *result;
+			}
+
+			void invalidate() noexcept { //requires lock
+				paths.clear();
+				unloadable.clear();
+				probe_epoch.fetch_add(1, std::memory_order_relaxed);
+			}
+		};
+
+		auto locator() -> locator_t & {
+			static locator_t instance;
+			return instance;
+		}
+
+	#ifdef CWC_STATIC_REGISTRY
+		auto linked(const char * dll) noexcept -> const export_table * { //libraries are only names of the export tables linked into the executable
+			for(auto it{export_registrar::list()}; it; it = it->next)
+				if(it->table->count && std::strcmp(it->table->entries->entry->library, dll) == 0) //all entries of a table belong to the same library
+					return it->table;
+			return nullptr;
+		}
+	#endif
+
+		auto locate(const char * dll, const char * class_, version ver, errc & ec) -> key {
+		#ifdef CWC_STATIC_REGISTRY
+			static_cast<void>(class_);
+			static_cast<void>(ver);
+			if(linked(dll)) return std::filesystem::path{dll}.native();
+			if(recording()) record(&statistics_t::libraries, library_record{dll, {}, {}, 0, "not found"});
+			ec = errc::library_not_found;
+			return {};
+		#else
+			return locator().locate(dll, class_, ver, ec);
+		#endif
+		}
 	}
 
-	struct context::native_handle final {
-		handle lib;
+	struct context::image final {
+		handle lib{};
+		const export_table * exports{nullptr};
+		std::atomic<std::size_t> instances{0};
+		std::unordered_map<const context *, binding> bindings; //node-based => addresses of bindings are stable, only erased with their context as pin may still read them without the lock
 
-		native_handle(const char * dll) {
-			auto end{dll};
-			while(*end != '\0') ++end;
-			const auto it{std::find(std::make_reverse_iterator(end), std::make_reverse_iterator(dll), '/').base()};
+		image() noexcept =default;
+		image(const image &) =delete;
+		auto operator=(const image &) -> image & =delete;
+		~image() noexcept { if(lib) FreeLibrary(lib); }
 
-			auto fullpath{base_path};
-			if(it != dll) fullpath += std::string_view{dll, static_cast<std::size_t>(it - dll)};
-			fullpath += dll_prefix;
-			fullpath += std::string_view{it, static_cast<std::size_t>(end - it)};
-			fullpath += dll_suffix;
+		auto loaded() const noexcept -> bool { return lib || exports; } //libraries of the static registry only consist of exports
+
+		auto resolve(const char * dll, const char * class_, version ver, std::size_t capacity, errc & ec) const -> const header * { //capacity => handles expect the vtable layout of inline storage
+			const auto start{recording() ? clock::now() : clock::time_point{}};
+			const auto h{[&]() -> const header * { //requires loaded()
+				const auto hash{internal::hash(class_)};
+				const auto first{exports->entries}, last{first + exports->count};
+				for(auto it{std::lower_bound(first, last, hash, [](const exported & e, std::uint64_t h) { return e.hash < h; })}; it != last && it->hash == hash; ++it)
+					if(std::strcmp(it->entry->name, class_) == 0) return reinterpret_cast<const header *>(it->entry->vtable);
+				return nullptr;
+			}()};
+			const auto incompatible{[&] { return h->hversion < header::minimum || ((h->features & feature::inline_layout) != 0) != (capacity != 0); }}; //hversion and cversion are located at the same offsets in all layouts
+			const auto failure{!h ? errc::entry_point_not_found : incompatible() ? errc::incompatible_layout : h->cversion < ver ? errc::version_mismatch : errc{}};
+			if(start != clock::time_point{}) record(&statistics_t::components, component_record{class_, dll, clock::now() - start, ver, h ? h->cversion : version{0}, failure == errc::entry_point_not_found ? "entry point not found" : failure == errc::incompatible_layout ? "incompatible layout" : failure == errc::version_mismatch ? "version mismatch" : "ok"});
+			if(failure != errc{}) {
+				ec = failure;
+				return nullptr;
+			}
+			return h;
+		}
+
+		auto bind(const context & ctx, const header * h) -> const binding * { //requires h->hversion >= header::minimum
+			const auto announced{h->features & (feature::all & ~feature::inline_storage)}; //inline storage is only negotiated
+			auto features{h->toolset && h->toolset == toolset_fingerprint() ? announced : announced & ~feature::native_exceptions};
+			if(h->isize && h->isize <= ctx.capacity && h->ialign <= alignof(std::max_align_t)) features |= feature::inline_storage; //handles reserve storage aligned for any scalar type
+			const auto [it, inserted]{bindings.try_emplace(&ctx, reinterpret_cast<const char *>(h) + h->size, &instances, static_cast<std::uint8_t>(features))};
+			if(!inserted) it->second.entry.store({reinterpret_cast<const char *>(h) + h->size, static_cast<std::uint8_t>(features)}, std::memory_order_release); //image was recycled
+			return &it->second;
+		}
+
+		void recycle() noexcept { for(auto & [ctx, b] : bindings) b.entry.store({}, std::memory_order_release); } //bindings of the previous library are resolved again on demand
+	};
 
-			lib = LoadLibrary(fullpath.c_str());
-			if(!lib) throw std::runtime_error{"could not load library"};
+	struct context::library final {
+		const key * path{nullptr}; //points into registry
+		key source; //file the next image is loaded from, differs from path after a swap
+		std::string name; //as passed to @library, only used for statistics
+		std::atomic<std::size_t> refs{1}; //contexts and pins referring to this library
+		std::atomic<bool> pinned{false};
+		std::mutex mutex; //serializes loading, binding and unloading
+		std::list<image> images; //unloaded images are recycled instead of erased while contexts may still refer to their bindings
+		image * current{nullptr};
+
+		library() noexcept =default;
+		library(const library &) =delete;
+		auto operator=(const library &) -> library & =delete;
+
+		static
+		auto acquire(const char * dll, const key & fullpath) -> library * {
+			auto & r{registry()};
+			const std::lock_guard lock{r.mutex};
+			const auto [it, inserted]{r.libraries.try_emplace(fullpath)};
+			auto & result{it->second};
+			if(!inserted) result.refs.fetch_add(1, std::memory_order_relaxed);
+			else try {
+				result.path = &it->first;
+				result.source = fullpath;
+				result.name = dll;
+			} catch(...) {
+				r.libraries.erase(it);
+				throw;
+			}
+			return &result;
 		}
 
-		native_handle(const native_handle &) =delete;
-		auto operator=(const native_handle &) -> native_handle & =delete;
+		static
+		auto acquire(const char * dll, const char * class_, version ver, errc & ec) -> library * {
+			const auto fullpath{locate(dll, class_, ver, ec)};
+			return fullpath.empty() ? nullptr : acquire(dll, fullpath);
+		}
 
-		~native_handle() noexcept { FreeLibrary(lib); }
+		auto load(const key & file, errc & ec) -> image * { //requires lock
+			const auto unloaded{std::find_if(images.begin(), images.end(), [](const image & img) { return !img.loaded(); })};
+			auto & result{unloaded != images.end() ? *unloaded : images.emplace_back()};
+			result.recycle();
+		#ifdef CWC_STATIC_REGISTRY
+			static_cast<void>(ec);
+			static_cast<void>(prefault); //load policies only apply to dynamically loaded images
+			static_cast<void>(mapped_size);
+			result.exports = linked(name.c_str());
+			if(recording()) record(&statistics_t::libraries, library_record{name, std::filesystem::path{file}.u8string(), {}, 0, "linked"}); //TODO: [C++20] u8string returns std::u8string
+		#else
+			const auto start{recording() ? clock::now() : clock::time_point{}};
+			const auto lib{LoadLibrary(file.c_str())};
+			const auto exports{lib ? reinterpret_cast<decltype(&cwc_exports)>(GetProcAddress(lib, "cwc_exports")) : nullptr}; //libraries without export table (e.g. built before it was introduced) are rejected
+			if(exports) {
+				result.lib = lib;
+				result.exports = exports();
+				const auto p{policy.load(std::memory_order_relaxed)};
+				if((p & (load_policy::prefault | load_policy::lock)) != load_policy::lazy) prefault(result.lib, (p & load_policy::lock) != load_policy::lazy);
+				if((p & load_policy::warmup) != load_policy::lazy)
+					if(const auto warmup{reinterpret_cast<void(*)() noexcept>(GetProcAddress(result.lib, "cwc_warmup"))}) warmup();
+			} else if(lib) FreeLibrary(lib);
+			if(start != clock::time_point{}) record(&statistics_t::libraries, library_record{name, std::filesystem::path{file}.u8string(), clock::now() - start, result.lib ? mapped_size(result.lib) : 0, result.lib ? "loaded" : lib ? "no export table" : "load failed"}); //TODO: [C++20] u8string returns std::u8string
+			if(!result.lib) {
+				prune();
+				if(file == *path) try { //best effort, failing to cache the failure is not an error on its own
+					auto & l{locator()};
+					const std::lock_guard lock{l.mutex};
+					l.unloadable.insert(file);
+				} catch(...) {}
+				ec = lib ? errc::incompatible_layout : errc::library_not_loadable;
+				return nullptr;
+			}
+		#endif
+			return &result;
+		}
 
-		auto resolve(const char * class_) const -> const void * {
-			using namespace std::string_literals;
-			const auto ptr{reinterpret_cast<const void *>(GetProcAddress(lib, ("cwc_export_"s + class_).c_str()))};
-			if(!ptr) throw std::runtime_error{"could not find entry point"};
-			return ptr;
+		auto loaded(errc & ec) -> image * { //requires lock
+			if(!current || !current->loaded()) {
+				const auto result{load(source, ec)};
+				if(!result) return nullptr;
+				current = result;
+			}
+			return current;
+		}
+
+		auto bind(const context & ctx, errc & ec) -> const binding * { //requires lock
+			const auto img{loaded(ec)};
+			if(!img) return nullptr;
+			if(const auto it{img->bindings.find(&ctx)}; it != img->bindings.end() && it->second.vptr()) return &it->second;
+			const auto h{img->resolve(name.c_str(), ctx.class_, ctx.ver, ctx.capacity, ec)};
+			if(!h) return nullptr;
+			return img->bind(ctx, h);
+		}
+
+		void unbind(const context & ctx) noexcept { //requires lock
+			for(auto & img : images) img.bindings.erase(&ctx);
+			prune();
+		}
+
+		void prune() noexcept { //requires lock, erases unloaded images no context is bound to
+			for(auto it{images.begin()}; it != images.end();)
+				if(it->loaded() || !it->bindings.empty()) ++it;
+				else {
+					if(&*it == current) current = nullptr;
+					it = images.erase(it);
+				}
+		}
+
+		auto swap(key file, errc & ec) -> bool { //requires lock
+			const auto img{load(file, ec)};
+			if(!img) return false;
+
+			std::vector<std::pair<const context *, const header *>> rebound; //validate all contexts before publishing anything
+			if(current) {
+				for(const auto & [ctx, b] : current->bindings) {
+					const auto h{img->resolve(name.c_str(), ctx->class_, ctx->ver, ctx->capacity, ec)};
+					if(!h) {
+						FreeLibrary(std::exchange(img->lib, nullptr));
+						img->exports = nullptr;
+						prune();
+						return false;
+					}
+					rebound.emplace_back(ctx, h);
+				}
+			}
+			for(const auto & [ctx, h] : rebound) img->bind(*ctx, h); //TODO: [C++20] use reserve on unordered_map
+
+			for(const auto & [ctx, b] : img->bindings) ctx->current.store(&b, std::memory_order_release); //new instances use the new image from now on, existing ones keep using the old one
+			current = img;
+			source = std::move(file);
+			return true;
+		}
+
+		void release() noexcept {
+			for(auto count{refs.load(std::memory_order_relaxed)}; count > 1;) //fast path: not the last reference
+				if(refs.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) return;
+
+			auto & r{registry()};
+			const std::lock_guard lock{r.mutex}; //last reference (as far as we know) => acquire can no longer race with us
+			if(refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+			r.libraries.erase(r.libraries.find(*path));
+		}
+
+		static
+		auto release_unused() noexcept -> std::size_t {
+		#ifdef CWC_STATIC_REGISTRY
+			return 0; //nothing to unload
+		#else
+			auto & r{registry()};
+			const std::lock_guard lock{r.mutex};
+			std::size_t result{0};
+			for(auto & [path, l] : r.libraries) {
+				const std::lock_guard lock{l.mutex}; //instances only leave zero while holding the lock
+				for(auto & img : l.images) {
+					if(!img.lib || (&img == l.current && l.pinned.load(std::memory_order_relaxed)) || img.instances.load(std::memory_order_acquire)) continue;
+					FreeLibrary(std::exchange(img.lib, nullptr));
+					img.exports = nullptr;
+					++result;
+				}
+				l.prune();
+			}
+			return result;
+		#endif
+		}
+	private:
+		struct registry_t final {
+			std::mutex mutex;
+			std::unordered_map<key, library> libraries; //node-based => addresses of libraries are stable
+		};
+
+		static
+		auto registry() -> registry_t & {
+			static registry_t instance;
+			return instance;
 		}
 	};
 
-	context::context(const char * dll, const char * class_, version ver) : lib{std::make_unique<const native_handle>(dll)} {
-		const auto ptr{lib->resolve(class_)};
-		const auto & h{*reinterpret_cast<const header *>(ptr)};
-		//TODO: handle different header versions (changes will always only be additive)
-		if(h.cversion < ver) throw std::runtime_error{"version mismatch detected"};
-		vptr = reinterpret_cast<const char *>(ptr) + h.size;
+	context::context(const char * dll, const char * class_, version ver, std::size_t capacity) : class_{class_}, ver{ver}, capacity{capacity} {
+		errc ec{};
+		lib = library::acquire(dll, class_, ver, ec);
+		if(!lib) throw std::system_error{ec};
+		try {
+			const std::lock_guard lock{lib->mutex}; //loading happens outside of the registry lock, so independent libraries don't serialize each other
+			const auto b{lib->bind(*this, ec)};
+			if(!b) throw std::system_error{ec};
+			current.store(b, std::memory_order_relaxed);
+		} catch(...) {
+			lib->release();
+			throw;
+		}
+	}
+
+	context::~context() noexcept {
+		{
+			const std::lock_guard lock{lib->mutex};
+			lib->unbind(*this);
+		}
+		lib->release();
+	}
+
+	auto context::pin() const -> const binding * {
+		const auto b{current.load(std::memory_order_acquire)};
+		for(auto count{b->instances->load(std::memory_order_relaxed)}; count > 0;) //fast path: image is kept loaded by other instances
+			if(b->instances->compare_exchange_weak(count, count + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+				if(b->entry.load(std::memory_order_acquire)) return b;
+				b->unpin(); //image was recycled, but this context was not bound to it again yet
+				break;
+			}
+
+		const std::lock_guard lock{lib->mutex};
+		errc ec{};
+		const auto result{lib->bind(*this, ec)}; //binds to the current image, reloading the library if it was unloaded
+		if(!result) throw std::system_error{ec};
+		result->instances->fetch_add(1, std::memory_order_release); //publishes the binding of a recycled image to the fast path
+		current.store(result, std::memory_order_release);
+		return result;
 	}
 
-	context::~context() noexcept =default;
+	void context::pin(const char * dll) {
+		errc ec{};
+		const auto fullpath{locate(dll, "", 0, ec)};
+		if(fullpath.empty()) throw std::system_error{ec};
+		const auto lib{library::acquire(dll, fullpath)};
+		{
+			const std::lock_guard lock{lib->mutex};
+			if(lib->loaded(ec) && !lib->pinned.exchange(true)) return;
+		}
+		lib->release(); //failed to load or already pinned by a previous call
+		if(ec != errc{}) throw std::system_error{ec};
+	}
+
+	void context::swap(const char * dll, const std::filesystem::path & replacement) {
+	#ifdef CWC_STATIC_REGISTRY
+		static_cast<void>(dll);
+		static_cast<void>(replacement);
+		throw std::system_error{std::make_error_code(std::errc::operation_not_supported), "static registry"};
+	#else
+		errc ec{};
+		const auto fullpath{locate(dll, "", 0, ec)};
+		if(fullpath.empty()) throw std::system_error{ec};
+		const auto lib{library::acquire(dll, fullpath)};
+		try {
+			const std::lock_guard lock{lib->mutex};
+			if(!lib->swap((base_path / replacement).lexically_normal().native(), ec)) throw std::system_error{ec};
+		} catch(...) {
+			lib->release();
+			throw;
+		}
+		lib->release();
+		probe_epoch.fetch_add(1, std::memory_order_relaxed); //results memoized from the previous build are stale
+	#endif
+	}
+
+	auto context::probe(const char * dll, const char * class_, version ver, std::size_t capacity) noexcept -> std::error_code try {
+		errc ec{};
+		const auto lib{library::acquire(dll, class_, ver, ec)};
+		if(!lib) return ec;
+		{
+			const std::lock_guard lock{lib->mutex};
+			if(const auto img{lib->loaded(ec)}) img->resolve(lib->name.c_str(), class_, ver, capacity, ec);
+		}
+		lib->release();
+		return ec;
+	} catch(const std::bad_alloc &) {
+		return std::make_error_code(std::errc::not_enough_memory);
+	} catch(...) {
+		return std::make_error_code(std::errc::io_error); //e.g. filesystem errors while probing search paths
+	}
+
+	auto context::release_unused() noexcept -> std::size_t { return library::release_unused(); }
+
+	auto context::epoch() noexcept -> std::uint32_t { return probe_epoch.load(std::memory_order_relaxed); }
+
+	auto context::identity() noexcept -> std::uint64_t {
+		static std::atomic<std::uint64_t> next{0};
+		return next.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	auto category() noexcept -> const std::error_category & {
+		static const struct category_t final : std::error_category {
+			auto name() const noexcept -> const char * override { return "cwc"; }
+
+			auto message(int value) const -> std::string override {
+				switch(static_cast<errc>(value)) {
+					case errc::library_not_found:     return "could not find library";
+					case errc::library_not_loadable:  return "could not load library";
+					case errc::entry_point_not_found: return "could not find entry point";
+					case errc::version_mismatch:      return "version mismatch detected";
+					case errc::incompatible_layout:   return "incompatible binary layout detected";
+				}
+				return "unknown error";
+			}
+		} instance;
+		return instance;
+	}
+}
+
+namespace cwc {
+	void search_paths(std::vector<std::filesystem::path> paths) {
+		auto & l{internal::locator()};
+		const std::lock_guard lock{l.mutex};
+		l.search_paths = std::move(paths);
+		l.invalidate();
+	}
+
+	void load_manifest(const std::filesystem::path & file) {
+		const auto fullpath{internal::base_path / file};
+		std::ifstream is{fullpath};
+		if(!is) throw std::runtime_error{"could not open manifest"};
+
+		const auto directory{fullpath.parent_path()};
+		std::unordered_map<std::string, std::pair<internal::version, internal::key>> entries;
+		std::unordered_map<std::string, internal::key> libraries;
+		for(std::string line; std::getline(is, line);) {
+			if(line.empty() || line.front() == '#') continue;
+			std::istringstream ls{line}; //TODO: [C++23] use ispanstream here
+			std::string name, dll;
+			unsigned ver;
+			if(!(ls >> name >> ver) || !std::getline(ls >> std::ws, dll) || dll.empty() || ver > std::numeric_limits<internal::version>::max()) throw std::invalid_argument{"malformed manifest entry: " + line};
+			auto path{internal::library_path(directory, dll).native()};
+			libraries.insert_or_assign(std::move(dll), path);
+			entries.insert_or_assign(std::move(name), std::pair{static_cast<internal::version>(ver), std::move(path)});
+		}
+
+		auto & l{internal::locator()};
+		const std::lock_guard lock{l.mutex};
+		for(auto & e : entries) l.manifest.insert_or_assign(e.first, std::move(e.second));
+		for(auto & e : libraries) l.manifest_libraries.insert_or_assign(e.first, std::move(e.second));
+		l.invalidate();
+	}
+
+	auto release_unused() noexcept -> std::size_t { return internal::context::release_unused(); }
+
+	void set_load_policy(load_policy policy) noexcept { internal::policy.store(policy, std::memory_order_relaxed); }
+
+	void library_variants(std::vector<std::string> variants) {
+		auto & l{internal::locator()};
+		const std::lock_guard lock{l.mutex};
+		l.variants = std::move(variants);
+		l.invalidate();
+	}
+
+	auto library_variants() -> std::vector<std::string> {
+		auto & l{internal::locator()};
+		const std::lock_guard lock{l.mutex};
+		return l.variants;
+	}
+
+	void hot_swap(const char * library, const std::filesystem::path & replacement) { internal::context::swap(library, replacement); }
+
+	void refresh() noexcept {
+		auto & l{internal::locator()};
+		const std::lock_guard lock{l.mutex};
+		l.invalidate();
+	}
+
+	void record_load_statistics(bool enable) noexcept { internal::statistics().enabled.store(enable, std::memory_order_relaxed); }
+
+	void load_report(std::ostream & os, report_format format) {
+		using namespace internal;
+		auto & s{statistics()};
+		const std::lock_guard lock{s.mutex};
+		const auto flags{os.flags()};
+		const auto precision{os.precision()};
+		switch(format) {
+			case report_format::text: {
+				os << std::left << std::setw(24) << "library" << std::right << std::setw(12) << "load [us]" << std::setw(14) << "mapped [KiB]" << "  " << std::left << std::setw(12) << "status" << "path\n";
+				for(const auto & l : s.libraries) os << std::left << std::setw(24) << l.name << std::right << std::fixed << std::setprecision(1) << std::setw(12) << microseconds(l.load) << std::setw(14) << l.mapped / 1024 << "  " << std::left << std::setw(12) << l.status << l.path << '\n';
+				os << '\n';
+				os << std::left << std::setw(48) << "component" << std::setw(24) << "library" << std::right << std::setw(12) << "lookup [us]" << std::setw(10) << "required" << std::setw(10) << "provided" << "  status\n";
+				for(const auto & c : s.components) os << std::left << std::setw(48) << c.name << std::setw(24) << c.library << std::right << std::fixed << std::setprecision(1) << std::setw(12) << microseconds(c.lookup) << std::setw(10) << static_cast<int>(c.required) << std::setw(10) << static_cast<int>(c.provided) << "  " << c.status << '\n';
+			} break;
+			case report_format::json: {
+				os << "{\"libraries\":[";
+				auto first{true}; //TODO: [C++20] merge into for-loop
+				for(const auto & l : s.libraries) {
+					if(first) first = false;
+					else os << ",";
+					os << "{\"name\":";
+					write_json(os, l.name);
+					os << ",\"path\":";
+					write_json(os, l.path);
+					os << ",\"load_ns\":" << std::chrono::duration_cast<std::chrono::nanoseconds>(l.load).count() << ",\"mapped_bytes\":" << l.mapped << ",\"status\":\"" << l.status << "\"}";
+				}
+				os << "],\"components\":[";
+				first = true;
+				for(const auto & c : s.components) {
+					if(first) first = false;
+					else os << ",";
+					os << "{\"name\":";
+					write_json(os, c.name);
+					os << ",\"library\":";
+					write_json(os, c.library);
+					os << ",\"lookup_ns\":" << std::chrono::duration_cast<std::chrono::nanoseconds>(c.lookup).count() << ",\"required_version\":" << static_cast<int>(c.required) << ",\"provided_version\":" << static_cast<int>(c.provided) << ",\"status\":\"" << c.status << "\"}";
+				}
+				os << "]}\n";
+			} break;
+		}
+		os.flags(flags);
+		os.precision(precision);
+	}
 }
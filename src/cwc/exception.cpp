@@ -12,10 +12,11 @@
 #include <cassert>
 #include <cstring>
 #include <variant>
+#include <iterator>
 #include <optional>
 #include <stdexcept>
+#include <algorithm>
 #include <functional>
-#include <unordered_map>
 #include <cwc/cwc.hpp>
 
 namespace cwc {
@@ -151,7 +152,13 @@ namespace cwc::internal {
 			else static_assert(dependent_false_v<Exception>);
 		}
 
-		enum class operation { dtor, what, type, };
+		enum class operation { dtor, what, type, native, };
+
+		struct native_exception final { //forwarded as is, only used if both sides share the same toolset
+			std::exception_ptr ptr;
+			const char * what; //owned by the exception referenced by ptr
+			std::uint64_t type;
+		};
 	}
 
 	struct exception::vtable final { //TODO: rethink layout? (double indirection is actually unnecessary as we don't really need a vtable...)
@@ -168,11 +175,43 @@ namespace cwc::internal {
 			func(operation::type, self, &result);
 			return result;
 		}
+		auto native(const unsigned char * self) const noexcept -> const std::exception_ptr * { //nullptr => exception was copied
+			const std::exception_ptr * result;
+			func(operation::native, self, &result);
+			return result;
+		}
 	};
 
 	template<typename T>
-	void exception::store(const T & exc) noexcept {
-		static_assert(sizeof(T) <= sizeof(buffer));
+	void exception::store(unsigned char * buffer, const T & exc, bool forward) noexcept {
+		if(native && forward) { //both sides share the same toolset => forward as is
+			static_assert(sizeof(native_exception) <= size);
+			static constexpr vtable vtable{
+				+[](operation op, const unsigned char * obj, void * param) noexcept {
+					const auto & self{*reinterpret_cast<const native_exception *>(obj)};
+					switch(op) {
+						case operation::dtor:
+							self.~native_exception();
+							break;
+						case operation::what:
+							*reinterpret_cast<const char **>(param) = self.what;
+							break;
+						case operation::type:
+							*reinterpret_cast<std::uint64_t *>(param) = self.type;
+							break;
+						case operation::native:
+							*reinterpret_cast<const std::exception_ptr **>(param) = &self.ptr;
+							break;
+					}
+				}
+			};
+			vptr = &vtable;
+			new(buffer) native_exception{std::current_exception(), exc.what(), error_code(exc)};
+			return;
+		}
+
+		static_assert(sizeof(T) <= size);
+		static_assert(alignof(T) <= alignof(std::max_align_t));
 		static_assert(std::is_nothrow_copy_constructible_v<T>);
 		static_assert(std::is_nothrow_destructible_v<T>);
 
@@ -189,6 +228,9 @@ namespace cwc::internal {
 					case operation::type:
 						*reinterpret_cast<std::uint64_t *>(param) = error_code(self);
 						break;
+					case operation::native:
+						*reinterpret_cast<const std::exception_ptr **>(param) = nullptr;
+						break;
 				}
 			}
 		};
@@ -196,47 +238,41 @@ namespace cwc::internal {
 		new(buffer) T{exc};
 	}
 
-	void exception::catch_() noexcept { //lippincott function
+	void exception::catch_(unsigned char * buffer) noexcept { //lippincott function
 		try { throw; }
-			catch(const std::bad_optional_access & exc) { store(exc); }
-			catch(const std::bad_variant_access & exc) { store(exc); }
-			catch(const std::bad_function_call & exc) { store(exc); }
-			catch(const std::bad_weak_ptr & exc) { store(exc); }
-			catch(const std::bad_exception & exc) { store(exc); }
-				catch(const std::bad_array_new_length & exc) { store(exc); }
-			catch(const std::bad_alloc & exc) { store(exc); }
-				catch(const std::bad_any_cast & exc) { store(exc); }
-			catch(const std::bad_cast & exc) { store(exc); }
-			catch(const std::bad_typeid & exc) { store(exc); }
-				//TODO: [C++20] catch(const std::format_error & exc) { store(exc); }
-				catch(const std::regex_error & exc) { store(exc); }
-				catch(const std::ios_base::failure & exc) { store(exc); }
-				catch(const std::underflow_error & exc) { store(exc); }
-				catch(const std::overflow_error & exc) { store(exc); }
-				catch(const std::range_error & exc) { store(exc); }
-			catch(const std::runtime_error & exc) { store(exc); }
-				catch(const std::future_error & exc) { store(exc); }
-				catch(const std::out_of_range & exc) { store(exc); }
-				catch(const std::length_error & exc) { store(exc); }
-				catch(const std::domain_error & exc) { store(exc); }
-				catch(const std::invalid_argument & exc) { store(exc); }
-			catch(const std::logic_error & exc) { store(exc); }
-			catch(const unknown_exception & exc) { store(exc); }
-		catch(const std::exception & exc) { store(exc); }
-		catch(...) { store(unknown_exception{}); }
+			catch(const std::bad_optional_access & exc) { store(buffer, exc); }
+			catch(const std::bad_variant_access & exc) { store(buffer, exc); }
+			catch(const std::bad_function_call & exc) { store(buffer, exc); }
+			catch(const std::bad_weak_ptr & exc) { store(buffer, exc); }
+			catch(const std::bad_exception & exc) { store(buffer, exc); }
+				catch(const std::bad_array_new_length & exc) { store(buffer, exc); }
+			catch(const std::bad_alloc & exc) { store(buffer, exc); }
+				catch(const std::bad_any_cast & exc) { store(buffer, exc); }
+			catch(const std::bad_cast & exc) { store(buffer, exc); }
+			catch(const std::bad_typeid & exc) { store(buffer, exc); }
+				//TODO: [C++20] catch(const std::format_error & exc) { store(buffer, exc); }
+				catch(const std::regex_error & exc) { store(buffer, exc); }
+				catch(const std::ios_base::failure & exc) { store(buffer, exc); }
+				catch(const std::underflow_error & exc) { store(buffer, exc); }
+				catch(const std::overflow_error & exc) { store(buffer, exc); }
+				catch(const std::range_error & exc) { store(buffer, exc); }
+			catch(const std::runtime_error & exc) { store(buffer, exc); }
+				catch(const std::future_error & exc) { store(buffer, exc); }
+				catch(const std::out_of_range & exc) { store(buffer, exc); }
+				catch(const std::length_error & exc) { store(buffer, exc); }
+				catch(const std::domain_error & exc) { store(buffer, exc); }
+				catch(const std::invalid_argument & exc) { store(buffer, exc); }
+			catch(const std::logic_error & exc) { store(buffer, exc); }
+			catch(const unknown_exception & exc) { store(buffer, exc); }
+		catch(const std::exception & exc) { store(buffer, exc); }
+		catch(...) { store(buffer, unknown_exception{}, false); } //types not derived from std::exception are never forwarded
 	}
 
-	exception::exception() noexcept {
-		static constexpr vtable vtable{
-			+[](operation op, const unsigned char *, void * param) noexcept {
-				if(op == operation::type) *reinterpret_cast<std::uint64_t *>(param) = 0;
-			}
-		};
-		vptr = &vtable;
+	void exception::destroy(unsigned char * buffer) noexcept {
+		vptr->dtor(buffer);
+		vptr = nullptr;
 	}
 
-	exception::~exception() noexcept { vptr->dtor(buffer); }
-
 	namespace {
 		template<typename Exception>
 		void throw_(const char * msg) {
@@ -267,7 +303,13 @@ namespace cwc::internal {
 
 		struct ios_base_failure_iostream_error_stream : std::ios::failure { ios_base_failure_iostream_error_stream(const char * msg) : std::ios::failure{msg, std::io_errc::stream} {} };
 
-		const std::unordered_map<std::uint64_t, void(*)(const char *)> exceptions{
+		struct rethrower final {
+			std::uint64_t error;
+			void(*func)(const char *);
+		};
+
+		constexpr
+		rethrower exceptions[]{ //sorted by error => no initialization at startup, binary search for lookups
 			{std98_exception, throw_<std::exception>},
 			{std98_logic_error, throw_<std::logic_error>},
 			{std98_invalid_argument, throw_<std::invalid_argument>},
@@ -310,6 +352,12 @@ namespace cwc::internal {
 			{std17_bad_optional_access, throw_<std::bad_optional_access>},
 			{cwc_unknown_exception, throw_<unknown_exception>}
 		};
+		static_assert([] {
+			for(std::size_t i{1}; i < std::size(exceptions); ++i)
+				if(exceptions[i - 1].error >= exceptions[i].error)
+					return false;
+			return true;
+		}(), "exceptions must be sorted by error");
 
 		constexpr
 		std::uint64_t masks[]{
@@ -323,16 +371,65 @@ namespace cwc::internal {
 			~(std::uint64_t{0xFF} << 48),
 			~(std::uint64_t{0xFF} << 56)
 		};
+
+		auto escapable(const void * origin) noexcept -> bool { //rethrown exceptions may outlive any reference to them => keep the library that threw loaded for good
+		#ifdef CWC_STATIC_REGISTRY
+			static_cast<void>(origin);
+			return true; //libraries are never unloaded
+		#else
+			return !origin || retain_forever(origin);
+		#endif
+		}
+
+		[[noreturn]]
+		void rethrow(std::uint64_t error, const char * msg) {
+			for(auto mask : masks) { //from the exact type to its closest supported base
+				if(mask != masks[0] && !(error & ~mask)) continue; //level is unused => nothing new to look up
+				error &= mask;
+				const auto it{std::lower_bound(std::begin(exceptions), std::end(exceptions), error, [](const rethrower & lhs, std::uint64_t rhs) { return lhs.error < rhs; })};
+				if(it != std::end(exceptions) && it->error == error) it->func(msg);
+			}
+
+			std::abort(); //unreachable
+		}
 	}
 
-	void exception::throw_() const {
-		auto error{vptr->type(buffer)};
-		if(!error) return; //no exception stored...
+	void exception::rethrow(const unsigned char * buffer, const void * origin) const {
+		if(const auto ptr{vptr->native(buffer)}; ptr && escapable(origin)) std::rethrow_exception(*ptr);
+		internal::rethrow(vptr->type(buffer), vptr->what(buffer)); //fall back to the copied representation
+	}
 
-		for(auto mask : masks)
-			if(const auto it{exceptions.find(error &= mask)}; it != exceptions.end())
-				it->second(vptr->what(buffer));
+	auto exception::report(const unsigned char * buffer, const void * origin) const -> error {
+		const auto ptr{vptr->native(buffer)};
+		if(!ptr) return {vptr->type(buffer), vptr->what(buffer)};
+	#ifndef CWC_STATIC_REGISTRY
+		if(origin) { //the library may be unloaded while the error is still referenced
+			auto image{retain(origin)};
+			if(!image) return {vptr->type(buffer), vptr->what(buffer)}; //fall back to the copied representation
+			return {vptr->type(buffer), vptr->what(buffer), *ptr, std::move(image)};
+		}
+	#else
+		static_cast<void>(origin); //libraries are never unloaded
+	#endif
+		return {vptr->type(buffer), vptr->what(buffer), *ptr};
+	}
 
-		std::abort(); //unreachable
+	auto exception::current() -> error {
+		exception exc{true};
+		alignas(std::max_align_t) unsigned char buffer[size];
+		exc.catch_(buffer);
+		const struct releaser final {
+			exception & exc;
+			unsigned char * buffer;
+			~releaser() noexcept { exc.release(buffer); }
+		} guard{exc, buffer};
+		return exc.report(buffer);
+	}
+}
+
+namespace cwc {
+	void error::rethrow() const {
+		if(native && internal::escapable(native->image.get())) std::rethrow_exception(native->exception);
+		internal::rethrow(code_, what_.c_str()); //fall back to the copied representation
 	}
 }
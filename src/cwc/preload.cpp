@@ -0,0 +1,58 @@
+//          Copyright Michael Florian Hava.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file ../../LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cwc/cwc.hpp>
+
+namespace cwc::internal {
+	void preload(const preload_task * tasks, std::size_t count) {
+		std::mutex mutex;
+		std::vector<preload_error::failure> failures;
+		std::atomic<std::size_t> next{0};
+		auto worker{[&] {
+			for(std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;)
+				try { tasks[i].func(tasks[i].arg); }
+				catch(...) {
+					const std::lock_guard lock{mutex};
+					failures.push_back({i, std::current_exception()});
+				}
+		}};
+
+		std::vector<std::thread> workers;
+		try {
+			const auto concurrency{std::min<std::size_t>(count, std::max(std::thread::hardware_concurrency(), 1u))};
+			workers.reserve(concurrency);
+			for(std::size_t i{1}; i < concurrency; ++i) workers.emplace_back(worker);
+		} catch(...) {} //continue with the workers that could be started, the current thread always participates
+		worker();
+		for(auto & w : workers) w.join();
+
+		if(failures.empty()) return;
+		std::sort(failures.begin(), failures.end(), [](const auto & lhs, const auto & rhs) { return lhs.index < rhs.index; });
+		throw preload_error{std::move(failures)};
+	}
+}
+
+namespace cwc {
+	namespace {
+		void preload_libraries(const char * const * libraries, std::size_t count) {
+			std::vector<internal::preload_task> tasks;
+			tasks.reserve(count);
+			std::transform(libraries, libraries + count, std::back_inserter(tasks), [](const char * lib) { return internal::preload_task{internal::context::pin, lib}; });
+			internal::preload(tasks.data(), tasks.size());
+		}
+	}
+
+	preload_error::preload_error(std::vector<failure> failures) : std::runtime_error{"could not preload all components"}, failures_{std::move(failures)} {}
+
+	void preload(std::initializer_list<const char *> libraries) { preload_libraries(libraries.begin(), libraries.size()); }
+
+	auto preload_async(std::initializer_list<const char *> libraries) -> std::future<void> {
+		return std::async(std::launch::async, [libraries{std::vector<const char *>(libraries)}] { preload_libraries(libraries.data(), libraries.size()); });
+	}
+}
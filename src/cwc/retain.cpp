@@ -0,0 +1,69 @@
+
+//          Copyright Michael Florian Hava.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file ../../LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <new>
+#include <memory>
+#include <cwc/cwc.hpp>
+
+//separate from context.cpp as libraries forwarding exceptions link this as well
+
+#ifdef _WIN32
+	#define UNICODE
+	#define WIN32_LEAN_AND_MEAN
+	#define NOSERVICE
+	#define NOMCX
+	#define NOTIME
+	#define NOIME
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <Windows.h>
+
+	namespace {
+		using handle = HMODULE;
+
+		auto containing(const void * address) noexcept -> handle { //increments the reference count of the library
+			HMODULE result;
+			return GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, static_cast<LPCWSTR>(address), &result) ? result : nullptr;
+		}
+	}
+#elif defined(__linux__) || defined(__APPLE__)
+	#include <dlfcn.h>
+
+	#define FreeLibrary(dll) dlclose(dll)
+
+	namespace {
+		using handle = void *;
+
+		auto containing(const void * address) noexcept -> handle { //increments the reference count of the library
+			Dl_info info;
+			return dladdr(address, &info) && info.dli_fname ? dlopen(info.dli_fname, RTLD_NOW | RTLD_NOLOAD) : nullptr;
+		}
+	}
+#elif defined(__HAIKU__)
+	#include <image.h>
+
+	#define FreeLibrary(dll) unload_add_on(dll)
+
+	namespace {
+		using handle = image_id;
+
+		auto containing(const void *) noexcept -> handle { return 0; } //unsupported: load_add_on maps another copy instead of referencing the loaded image => native exceptions fall back to their copied representation
+	}
+#else
+	#error unknown operating system
+#endif
+
+namespace cwc::internal {
+	auto retain(const void * address) noexcept -> std::shared_ptr<const void> {
+		const auto lib{containing(address)};
+		if(!lib) return nullptr;
+		try { return {address, [lib](const void *) noexcept { FreeLibrary(lib); }}; }
+		catch(const std::bad_alloc &) { return nullptr; } //deleter was already invoked
+	}
+
+	auto retain_forever(const void * address) noexcept -> bool { return containing(address); } //the reference is intentionally never released
+}
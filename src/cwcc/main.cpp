@@ -14,23 +14,27 @@
 
 int main(int argc, char * argv[]) try {
 	if(argc == 1) {
-		std::cout << "usage: " << argv[0] << " <input> <output>\n";
+		std::cout << "usage: " << argv[0] << " [--manifest] <input> <output>\n";
 		return EXIT_SUCCESS;
 	}
-	if(argc != 3) throw std::invalid_argument{"invalid count of parameters"};
+	const auto manifest{argv[1] == std::string_view{"--manifest"}};
+	if(argc != 3 + manifest) throw std::invalid_argument{"invalid count of parameters"};
 
-	std::ifstream is{argv[1]};
+	std::ifstream is{argv[1 + manifest]};
 	if(!is) throw std::runtime_error{"could not open input file"};
-	std::ofstream os{argv[2], std::ios::binary};
+	std::ofstream os{argv[2 + manifest], std::ios::binary};
 	if(!os) throw std::runtime_error{"could not open output file"};
 
 	const std::string cwc(std::istreambuf_iterator<char>{is}, std::istreambuf_iterator<char>{});
 	cwcc::parser p{cwc};
-	std::stringstream ss;
 	cwcc::cwc c;
 	c.parse(p);
-	cwcc::generate(ss, c);
-	cwcc::indent(ss, os);
+	if(manifest) cwcc::generate_manifest(os, c);
+	else {
+		std::stringstream ss;
+		cwcc::generate(ss, c);
+		cwcc::indent(ss, os);
+	}
 } catch(const std::exception & exc) {
 	std::cerr << "ERROR: " << exc.what() << std::endl;
 }
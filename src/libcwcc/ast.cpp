@@ -4,15 +4,19 @@
 //    (See accompanying file ../../LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
+#include <cctype>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
 #include "ast.hpp"
 #include "parser.hpp"
 
 namespace cwcc {
 	void attribute::parse(parser & p) {
 		p.expect("[[");
-		name = p.expect_name();
+		name = p.expect_namespace();
 		if(p.consume("(")) {
-			reason = p.expect_string_literal();
+			reason = p.accept("\"") ? p.expect_string_literal() : p.expect_number(); //numbers are only used by directives
 			p.expect(")");
 		}
 		p.expect("]]");
@@ -51,6 +55,13 @@ namespace cwcc {
 	}
 
 	void method::parse(parser & p) {
+		while(p.accept("[[cwc::")) { //directives for CWCC, not emitted into the generated header
+			attribute a;
+			a.parse(p);
+			if(a.name == "cwc::batch" && !a.reason) batch = true;
+			else if(a.name == "cwc::pure" && (!a.reason || (std::isdigit(a.reason->front()) && *a.reason != "0"))) pure = a.reason.value_or("");
+			else throw std::invalid_argument{"unknown attribute " + std::string{a.name}};
+		}
 		static_ = p.consume("static");
 		const auto returning{p.consume("auto")};
 		if(!returning) p.expect("void");
@@ -81,6 +92,9 @@ namespace cwcc {
 		delete_ = p.consume("=");
 		if(delete_) p.expect("delete");
 		p.expect(";");
+		const auto by_value_or_const_ref{std::all_of(params.cbegin(), params.cend(), [](const param & p) { return p.ref == ref_t::none || p.const_; })};
+		if(pure && (!(static_ || const_) || delete_ || ref == ref_t::rvalue || !result || !by_value_or_const_ref)) throw std::invalid_argument{"[[cwc::pure]] requires a static or const method with a result and parameters passed by value or const reference"};
+		if(batch && (static_ || delete_ || ref == ref_t::rvalue || !result || params.size() != 1 || (params[0].ref != ref_t::none && !params[0].const_))) throw std::invalid_argument{"[[cwc::batch]] requires a non-static method with a result and a single parameter passed by value or const reference"};
 	}
 
 	void using_::parse(parser & p) {
@@ -97,13 +111,24 @@ namespace cwcc {
 		version = p.expect_version();
 		p.expect(")");
 		p.expect("component");
-		while(p.accept("[")) attributes.emplace_back().parse(p);
+		while(p.accept("[")) {
+			if(p.accept("[[cwc::")) { //directives for CWCC, not emitted into the generated header
+				attribute a;
+				a.parse(p);
+				if(a.name == "cwc::inline_storage" && a.reason && std::isdigit(a.reason->front()) && *a.reason != "0") inline_storage = a.reason;
+				else throw std::invalid_argument{"unknown attribute " + std::string{a.name}};
+			} else attributes.emplace_back().parse(p);
+		}
 		name = p.expect_name();
 		final = p.consume("final");
 		p.expect("{");
 
 		while(!p.consume("}")) {
-			if(p.accept("[")) {
+			if(p.accept("[[cwc::")) {
+				method m;
+				m.parse(p);
+				content.emplace_back(std::move(m));
+			} else if(p.accept("[")) {
 				attribute a;
 				a.parse(p);
 				content.emplace_back(std::move(a));
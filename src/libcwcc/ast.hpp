@@ -71,10 +71,12 @@ namespace cwcc {
 		bool noexcept_{false};
 		std::optional<std::string_view> result;
 		bool delete_{false};
+		bool batch{false}; //[[cwc::batch]] => additional method processing spans of parameters and results
+		std::optional<std::string_view> pure{}; //[[cwc::pure(capacity)]] => results are memoized by the consumer, empty capacity => default
 
 		void parse(parser & p);
 
-		auto view() const noexcept { return std::tie(static_, name, params, const_, ref, noexcept_, result, delete_); } //TODO: [C++20] remove as operator== will be defaulted
+		auto view() const noexcept { return std::tie(static_, name, params, const_, ref, noexcept_, result, delete_, batch, pure); } //TODO: [C++20] remove as operator== will be defaulted
 		friend
 		auto operator==(const method & lhs, const method & rhs) noexcept -> bool { return lhs.view() == rhs.view(); } //TODO: [C++20] mark defaulted
 	};
@@ -96,10 +98,11 @@ namespace cwcc {
 		std::string_view name;
 		bool final{false};
 		std::vector<std::variant<comment, constructor, method, attribute, using_>> content;
+		std::optional<std::string_view> inline_storage{}; //[[cwc::inline_storage(capacity)]] => handles reserve capacity bytes for the implementation
 
 		void parse(parser & p);
 
-		auto view() const noexcept { return std::tie(version, attributes, name, final, content); } //TODO: [C++20] remove as operator== will be defaulted
+		auto view() const noexcept { return std::tie(version, attributes, name, final, content, inline_storage); } //TODO: [C++20] remove as operator== will be defaulted
 		friend
 		auto operator==(const component & lhs, const component & rhs) noexcept -> bool { return lhs.view() == rhs.view(); } //TODO: [C++20] mark defaulted
 	};
@@ -4,8 +4,10 @@
 //    (See accompanying file ../../LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
+#include <string>
 #include <cassert>
 #include <sstream>
+#include <stdexcept>
 #include <algorithm>
 #include "ast.hpp"
 #include "generator.hpp"
@@ -25,81 +27,178 @@ namespace cwcc {
 				for(const auto & p : params) {
 					if(first) first = false;
 					else os << ", ";
+					if(p.ref == ref_t::none) os << "cwc::internal::param_t<";
 					if(p.const_) os << "const ";
 					os << p.type;
-					if(p.ref != ref_t::none) os << " *";
+					if(p.ref == ref_t::none) os << ">";
+					else os << " *";
 					if(Definition) os << " " << p.name;
 				}
 			}
 
-			const bool ctor{false}, explicit_{false}, const_{false}, delete_, noexcept_{false}, static_{true};
+			void self(std::ostream & os, std::string_view impl) const { //pointer to the implementation
+				os << "cwc::internal::self<";
+				if(const_) os << "const ";
+				os << impl << ">(cwc_self)";
+			}
+
+			void batch_call(std::ostream & os, std::string_view impl) const {
+				os << "cwc::internal::batch(*";
+				self(os, impl);
+				os << ", cwc_in, cwc_out, ";
+				os << "[](auto & cwc_impl, auto cwc_in, auto cwc_out) -> decltype(cwc_impl." << name << "(cwc_in, cwc_out)) { return cwc_impl." << name << "(cwc_in, cwc_out); }, "; //only used if provided by the implementation
+				os << "[](auto & cwc_impl, const auto & cwc_value) { return cwc_impl." << name << "(cwc_value); })";
+			}
+
+			const bool ctor{false}, explicit_{false}, const_{false}, delete_, noexcept_{false}, static_{true}, batch{false}, inline_{false}; //inline_ => constructed in the storage of the handle if it fits
 			const ref_t ref{ref_t::none};
 			const std::vector<param> & params; //TODO: [C++20] use span
 			const std::optional<std::string_view> result;
 			const std::string_view name;
+			const std::optional<std::string_view> pure; //capacity of the cache, empty => default
+			std::string batch_types[2]; //only used by batch methods, referenced by batch_params
+			std::vector<param> batch_params;
 		public:
-			vtable_entry(const constructor & c) noexcept : ctor{true}, explicit_{c.explicit_}, delete_{c.delete_}, params{c.params}, name{c.name} {}
-			vtable_entry(const method & m) noexcept : const_{m.const_}, delete_{m.delete_}, noexcept_{m.noexcept_}, static_{m.static_}, ref{m.ref}, params{m.params}, result{m.result}, name{m.name} {}
+			struct batch_t final {};
+
+			vtable_entry(const constructor & c, bool inline_) noexcept : ctor{true}, explicit_{c.explicit_}, delete_{c.delete_}, inline_{inline_}, params{c.params}, name{c.name} {}
+			vtable_entry(const method & m) noexcept : const_{m.const_}, delete_{m.delete_}, noexcept_{m.noexcept_}, static_{m.static_}, ref{m.ref}, params{m.params}, result{m.result}, name{m.name}, pure{m.pure} {}
+			vtable_entry(const method & m, batch_t) : const_{m.const_}, delete_{m.delete_}, noexcept_{m.noexcept_}, static_{m.static_}, batch{true}, ref{m.ref}, params{batch_params}, name{m.name} { //processes spans of parameters and results in a single call
+				assert(m.batch && m.params.size() == 1 && m.result);
+				batch_types[0] = "cwc::span<const " + std::string{m.params[0].type} + ">";
+				batch_types[1] = "cwc::span<" + std::string{*m.result} + ">";
+				batch_params = {param{false, batch_types[0], ref_t::none, "cwc_in"}, param{false, batch_types[1], ref_t::none, "cwc_out"}};
+			}
+			vtable_entry(const vtable_entry &) =delete; //params may refer to batch_params
+			auto operator=(const vtable_entry &) -> vtable_entry & =delete;
+
+			auto in_place() const noexcept -> bool { return noexcept_ && result; } //result is returned directly => no call context required
 
 			void declaration(std::ostream & os, std::size_t no) const {
 				if(delete_) return;
-				os << "void(*cwc_" << no << ")(";
-				os << "cwc::internal::call_context<" << result.value_or("void") << ", " << (noexcept_ ? "true" : "false") << "> *";
+				if(in_place()) os << *result << "(*cwc_" << no << ")(";
+				else {
+					if(result) os << "cwc::internal::returned_t<" << *result << ">(*cwc_" << no << ")(";
+					else os << "void(*cwc_" << no << ")(";
+					os << "cwc::internal::call_context<" << result.value_or("void") << ", " << (noexcept_ ? "true" : "false") << "> *";
+				}
 				if(!static_) {
-					os << ", ";
+					if(!in_place()) os << ", ";
 					if(const_) os << "const ";
 					os << "void *";
 				}
-				if(!params.empty()) generate_vtable<false>(os << ", ");
+				if(!params.empty()) {
+					if(!in_place() || !static_) os << ", ";
+					generate_vtable<false>(os);
+				}
 				if(ctor) os << ", void **";
 				os << ") noexcept;\n";
 			}
 
 			void definiton(std::ostream & os) const {
 				if(delete_) return;
-				os << "+[](cwc::internal::call_context<" << result.value_or("void") << ", " << (noexcept_ ? "true" : "false") << "> * cwc_ctx";
+				os << "+[](";
+				if(!in_place()) os << "cwc::internal::call_context<" << result.value_or("void") << ", " << (noexcept_ ? "true" : "false") << "> * cwc_ctx";
 				if(!static_) {
-					os << ", ";
+					if(!in_place()) os << ", ";
 					if(const_) os << "const ";
 					os << "void * cwc_self";
 				}
-				if(!params.empty()) generate_vtable<true>(os << ", ");
+				if(!params.empty()) {
+					if(!in_place() || !static_) os << ", ";
+					generate_vtable<true>(os);
+				}
 				if(ctor) os << ", void ** cwc_self";
-				os << ") noexcept { cwc_ctx->try_([&] { ";
-				if(ctor) os << "*cwc_self = new CWCImpl";
+				if(in_place()) os << ") noexcept -> " << *result << " { ";
+				else if(result) os << ") noexcept -> cwc::internal::returned_t<" << *result << "> { return cwc_ctx->try_([&] { ";
+				else os << ") noexcept { cwc_ctx->try_([&] { ";
+				if(batch) {
+					batch_call(os, "CWCImpl");
+					os << "; }); }";
+					return;
+				}
+				if(ctor) os << (inline_ ? "*cwc_self = cwc::internal::create_at<CWCImpl, CWCAllocation>" : "*cwc_self = cwc::internal::create<CWCImpl, CWCAllocation>");
 				else {
 					if(result) os << "return ";
 					if(static_) os << "CWCImpl::";
 					else {
-						if(ref == ref_t::rvalue) os << "std::move";
-						os << "reinterpret_cast<";
-						if(const_) os << "const ";
-						os << "CWCImpl *>(cwc_self)->";
+						if(ref == ref_t::rvalue) os << "std::move(*";
+						self(os, "CWCImpl");
+						os << (ref == ref_t::rvalue ? ")." : "->");
 					}
 					os << name;
 				}
 				os << "(";
+				if(inline_) os << (params.empty() ? "*cwc_self" : "*cwc_self, "); //storage selected by the consumer
 				auto first{true}; //TODO: [C++20] merge into for-loop
 				for(const auto & p : params) {
 					if(first) first = false;
 					else os << ", ";
 					switch(p.ref) {
-						case ref_t::none: os << "std::move("; break;
+						case ref_t::none: os << "cwc::internal::take<" << (p.const_ ? "const " : "") << p.type << ">("; break;
 						case ref_t::lvalue: os << "*"; break;
 						case ref_t::rvalue: os << "std::move(*"; break;
 					}
 					os << p.name;
 					if(p.ref != ref_t::lvalue) os << ")";
 				}
-				os << "); }); }";
+				os << (in_place() ? "); }" : "); }); }");
 			}
 
-			void wrapper(std::ostream & os, std::size_t no) const {
-				if(!ctor) {
-					if(static_) os << "static\n";
-					os << (result ? "auto" : "void") << " ";
-				} else if(explicit_) os << "explicit\n";
-				os << name << "(";
+			void direct_call(std::ostream & os, std::string_view direct) const {
+				if(batch) {
+					batch_call(os, direct);
+					os << ";";
+					return;
+				}
+				if(ctor) os << "cwc_self = cwc::internal::create<" << direct << ">";
+				else {
+					if(result) os << "return ";
+					if(static_) os << direct << "::";
+					else {
+						if(ref == ref_t::rvalue) os << "std::move(*";
+						self(os, direct);
+						os << (ref == ref_t::rvalue ? ")." : "->");
+					}
+					os << name;
+				}
+				os << "(";
+				auto first{true}; //TODO: [C++20] merge into for-loop
+				for(const auto & p : params) {
+					if(first) first = false;
+					else os << ", ";
+					if(p.ref == ref_t::lvalue) os << p.name;
+					else os << "std::move(" << p.name << ")";
+				}
+				os << ");";
+			}
+
+			void portable_call(std::ostream & os, std::size_t no, bool try_ = false) const { //try_ => errors are reported instead of thrown
+				if(result || try_) os << "return ";
+				if(ctor) os << (inline_ ? "cwc_binding = cwc_context().construct_at" : "cwc_binding = cwc_context().construct");
+				else if(static_) os << (try_ ? "cwc_context().try_call_static" : "cwc_context().call_static");
+				else os << (try_ ? "cwc_vptr.try_call" : "cwc_vptr.call");
+				os << "<&cwc_vtable::cwc_" << no << ">(";
+				if(ctor) {
+					os << (inline_ ? "cwc_vptr, &cwc_self, cwc_storage" : "cwc_vptr, &cwc_self");
+					if(!params.empty()) os << ", ";
+				} else if(!static_) {
+					os << "cwc_self";
+					if(!params.empty()) os << ", ";
+				}
+				auto first{true}; //TODO: [C++20] merge into for-loop
+				for(const auto & p : params) {
+					if(first) first = false;
+					else os << ", ";
+					if(p.ref != ref_t::none) os << "std::addressof(";
+					else os << "cwc::internal::pass(";
+					os << p.name << ")";
+				}
+				os << ");";
+			}
+
+			void signature(std::ostream & os) const {
+				os << "(";
 				auto first{true}; //TODO: [C++20] merge into for-loop
 				for(const auto & p : params) {
 					if(first) first = false;
@@ -120,30 +219,78 @@ namespace cwcc {
 					case ref_t::lvalue: os << "& ";  break;
 					case ref_t::rvalue: os << "&& "; break;
 				}
-				if(noexcept_) os << "noexcept ";
+			}
+
+			void memoized_call(std::ostream & os, std::size_t no) const {
+				os << "thread_local cwc::internal::memo<" << *result;
+				if(!static_) os << ", std::uint64_t"; //results of instances depend on their state
+				for(const auto & p : params) os << ", " << p.type;
+				os << "> cwc_memo{" << *pure << "};\n";
+				os << "return cwc_memo.get([&] { ";
+				portable_call(os, no);
+				os << " }";
+				if(!static_) os << ", cwc_identity";
+				for(const auto & p : params) os << ", " << p.name;
+				os << ");";
+			}
+
+			void wrapper(std::ostream & os, std::size_t no, std::string_view direct) const { //direct => name of the macro selecting the linked in implementation
+				if(!ctor) {
+					if(static_) os << "static\n";
+					os << (result ? "auto" : "void") << " ";
+				} else if(explicit_) os << "explicit\n";
+				os << name;
+				signature(os);
+				if(noexcept_ && !batch) os << "noexcept "; //batches reject too few results
 				if(!ctor && result) os << "-> " << *result << " ";
 				if(delete_) os << "=delete;\n";
-				else {
+				else if(direct.empty() && !pure) {
 					os << "{ ";
-					if(result) os << "return ";
-					os << "cwc_context().call<&cwc_vtable::cwc_" << no << ">(";
-					if(!static_) {
-						os << "cwc_self";
-						if(!params.empty() || result) os << ", ";
+					if(batch) os << "cwc::internal::check_batch(cwc_in, cwc_out); ";
+					portable_call(os, no);
+					os << " }\n";
+				} else {
+					os << "{\n";
+					if(batch) os << "cwc::internal::check_batch(cwc_in, cwc_out);\n";
+					if(!direct.empty()) {
+						os << "#ifdef " << direct << "\n";
+						direct_call(os, direct); //cheaper than looking up memoized results
+						os << "\n#else\n";
 					}
-					auto first{true}; //TODO: [C++20] merge into for-loop
-					for(const auto & p : params) {
-						if(first) first = false;
-						else os << ", ";
-						if(p.ref != ref_t::none) os << "std::addressof(";
-						else os << "std::move(";
-						os << p.name << ")";
-					}
-					if(ctor) {
-						if(!params.empty()) os << ", ";
-						os << "&cwc_self";
-					}
-					os << "); }\n";
+					if(pure) memoized_call(os, no);
+					else portable_call(os, no);
+					os << "\n";
+					if(!direct.empty()) os << "#endif\n";
+					os << "}\n";
+				}
+				os << "\n";
+			}
+
+			void try_wrapper(std::ostream & os, std::size_t no, std::string_view direct) const { //variant of a method that may throw, reporting errors instead of throwing them
+				if(ctor || noexcept_ || delete_) return;
+				if(static_) os << "static\n";
+				os << "auto try_" << (name == "operator()" ? "operator_call" : name); //operator() is the only supported operator
+				signature(os);
+				os << "-> cwc::expected<" << result.value_or("void") << "> ";
+				const auto check{"try { cwc::internal::check_batch(cwc_in, cwc_out); } catch(...) { return {cwc::unexpect, cwc::internal::exception::current()}; }"};
+				if(direct.empty()) {
+					os << "{ ";
+					if(batch) os << check << " ";
+					portable_call(os, no, true);
+					os << " }\n";
+				} else {
+					os << "{\n";
+					if(batch) os << check << "\n";
+					os << "#ifdef " << direct << "\n";
+					os << "try { ";
+					direct_call(os, direct);
+					if(!result) os << " return {};";
+					os << " }\n";
+					os << "catch(...) { return {cwc::unexpect, cwc::internal::exception::current()}; }\n";
+					os << "#else\n";
+					portable_call(os, no, true);
+					os << "\n#endif\n";
+					os << "}\n";
 				}
 				os << "\n";
 			}
@@ -225,6 +372,10 @@ namespace cwcc {
 			return mangled_name;
 		}
 
+		auto declaration(const std::string & mangled) -> std::string { return "CWC_LOCAL extern const cwc::internal::export_entry cwc_export_" + mangled; } //hidden => one entry per library
+
+		auto entry(const std::string & mangled, std::string_view lib) -> std::string { return declaration(mangled) + "; const cwc::internal::export_entry cwc_export_" + mangled + "{\"" + mangled + "\", " + std::string{lib} + ", &cwc_vtable_" + mangled + "}"; } //listed in CWC_EXPORTS_*
+
 		void generate_(std::ostream & os, const component & c, std::string_view ns, std::variant<const library *, const template_ *> ctx) { //TODO: [C++20] us span
 			os << "struct ";
 			if(!c.attributes.empty()) {
@@ -236,11 +387,30 @@ namespace cwcc {
 			os << c.name << " ";
 			if(c.final) os << "final ";
 			os << "{\n";
+			const auto inline_{c.inline_storage.has_value()}; //direct implementations are always allocated on the heap
+			const auto identified{std::any_of(c.content.cbegin(), c.content.cend(), [](const auto & c) { return std::holds_alternative<method>(c) && std::get<method>(c).pure && !std::get<method>(c).static_; })}; //memoized results are keyed by instance
 			os << c.name << "(const " << c.name << " &) =delete;\n";
-			os << c.name << "(" << c.name << " && cwc_other) noexcept : cwc_self{std::exchange(cwc_other.cwc_self, nullptr)} {}\n";
+			os << c.name << "(" << c.name << " && cwc_other) noexcept : cwc_self{std::exchange(cwc_other.cwc_self, nullptr)}, cwc_vptr{cwc_other.cwc_vptr}, cwc_binding{cwc_other.cwc_binding}";
+			if(identified) os << ", cwc_identity{cwc_other.cwc_identity}";
+			os << " {";
+			if(inline_) os << " if(cwc_self == cwc_other.cwc_storage) cwc_vptr.call<&cwc_vtable::cwc_relocate>(cwc_self = cwc_storage, cwc_other.cwc_storage); ";
+			os << "}\n";
 			os << "auto operator=(const " << c.name << " &) -> " << c.name << " & =delete;\n";
-			os << "auto operator=(" << c.name << " && cwc_other) noexcept -> " << c.name << " & { std::swap(cwc_self, cwc_other.cwc_self); return *this; }\n";
-			os << "~" << c.name << "() noexcept { cwc_context().call<&cwc_vtable::cwc_0>(cwc_self); }\n";
+			if(inline_) os << "auto operator=(" << c.name << " && cwc_other) noexcept -> " << c.name << " & { if(this != &cwc_other) { this->~" << c.name << "(); ::new(this) " << c.name << "(std::move(cwc_other)); } return *this; }\n"; //swapping would need a third storage
+			else os << "auto operator=(" << c.name << " && cwc_other) noexcept -> " << c.name << " & { std::swap(cwc_self, cwc_other.cwc_self); std::swap(cwc_vptr, cwc_other.cwc_vptr); std::swap(cwc_binding, cwc_other.cwc_binding); " << (identified ? "std::swap(cwc_identity, cwc_other.cwc_identity); " : "") << "return *this; }\n";
+			const auto mangled{mangle(ns, c.name)};
+			const auto direct{std::holds_alternative<const library *>(ctx) ? "CWC_DIRECT_" + mangled : std::string{}}; //templates are exported per instantiation
+			const auto portable_destroy{inline_ ? "cwc::internal::context::destroy<&cwc_vtable::cwc_0, &cwc_vtable::cwc_destroy_at>(cwc_binding, cwc_self, cwc_storage);" : "cwc::internal::context::destroy<&cwc_vtable::cwc_0>(cwc_binding, cwc_self);"};
+			if(direct.empty()) os << "~" << c.name << "() noexcept { " << portable_destroy << " }\n";
+			else {
+				os << "~" << c.name << "() noexcept {\n";
+				os << "#ifdef " << direct << "\n";
+				os << "cwc::internal::destroy<" << direct << ">(cwc_self);\n";
+				os << "#else\n";
+				os << portable_destroy << "\n";
+				os << "#endif\n";
+				os << "}\n";
+			}
 			os << "\n";
 
 			const auto default_ctor{[&]() -> std::optional<constructor> {
@@ -253,13 +423,26 @@ namespace cwcc {
 			}()};
 
 			std::size_t no{0}; //TODO: [C++20] merge into for-loop...
-			if(default_ctor) vtable_entry{*default_ctor}.wrapper(os, ++no);
+			if(default_ctor) vtable_entry{*default_ctor, inline_}.wrapper(os, ++no, direct);
 			for(const auto & c : c.content)
 				std::visit(combined{
 					[&](const comment & c) { generate_(os, c); },
 					[&](const attribute  & a) { generate_(os, a); os << "\n"; },
 					[&](const using_ & u) { generate_(os, u); os << "\n"; },
-					[&](const auto & c) { vtable_entry{c}.wrapper(os, ++no); }
+					[&](const constructor & c) {
+						const vtable_entry entry{c, inline_};
+						entry.wrapper(os, ++no, direct);
+						entry.try_wrapper(os, no, direct);
+					},
+					[&](const method & m) {
+						const vtable_entry entry{m};
+						entry.wrapper(os, ++no, direct);
+						entry.try_wrapper(os, no, direct);
+						if(!m.batch) return;
+						const vtable_entry batch{m, vtable_entry::batch_t{}};
+						batch.wrapper(os, ++no, direct);
+						batch.try_wrapper(os, no, direct);
+					}
 				}, c);
 			os << "private:\n";
 			os << "friend\n";
@@ -269,20 +452,32 @@ namespace cwcc {
 			os << "constexpr\n";
 			os << "cwc::internal::version cwc_version{" << c.version << "};\n";
 			os << "\n";
+			os << "static\n";
+			os << "constexpr\n";
+			os << "std::size_t cwc_capacity{" << c.inline_storage.value_or("0") << "};\n";
+			os << "\n";
 			os << "struct cwc_vtable final {\n";
 			os << "void(*cwc_0)(cwc::internal::call_context<void, true> *, void *) noexcept;\n";
+			if(inline_) { //independent of the version => follow the destructor
+				os << "void(*cwc_destroy_at)(void *) noexcept;\n";
+				os << "void(*cwc_relocate)(void *, void *) noexcept;\n";
+			}
 			no = 0; //TODO: [C++20] merge into for-loop...
-			if(default_ctor) vtable_entry{*default_ctor}.declaration(os, ++no);
+			if(default_ctor) vtable_entry{*default_ctor, inline_}.declaration(os, ++no);
 			for(const auto & c : c.content)
 				std::visit(combined{
 					[](const comment &) {},
 					[](const attribute &) {},
 					[](const using_ &) {},
-					[&](const auto & c) { vtable_entry{c}.declaration(os, ++no); }
+					[&](const constructor & c) { vtable_entry{c, inline_}.declaration(os, ++no); },
+					[&](const method & m) {
+						vtable_entry{m}.declaration(os, ++no);
+						if(m.batch) vtable_entry{m, vtable_entry::batch_t{}}.declaration(os, ++no);
+					}
 				}, c);
 			os << "};\n";
 			os << "\n";
-			os << "template<typename CWCImpl>\n";
+			os << "template<typename CWCImpl, typename CWCAllocation>\n";
 			os << "static\n";
 			os << "constexpr\n";
 			os << "auto cwc_export() noexcept {\n";
@@ -291,15 +486,24 @@ namespace cwcc {
 			os << "cwc_vtable vtable;\n";
 			os << "};\n";
 			os << "return cwc_result{\n";
-			os << "cwc_version,\n";
-			os << "+[](cwc::internal::call_context<void, true> *, void * cwc_self) noexcept { delete reinterpret_cast<CWCImpl *>(cwc_self); }";
-			if(default_ctor) vtable_entry{*default_ctor}.definiton(os << ",\n");
+			os << "cwc::internal::header::of<CWCImpl>(cwc_version" << (inline_ ? ", true" : "") << "),\n";
+			os << "+[](cwc::internal::call_context<void, true> *, void * cwc_self) noexcept { cwc::internal::destroy<CWCImpl, CWCAllocation>(cwc_self); }";
+			if(inline_) {
+				os << ",\n+[](void * cwc_self) noexcept { cwc::internal::destroy_at<CWCImpl>(cwc_self); }";
+				os << ",\n+[](void * cwc_target, void * cwc_source) noexcept { cwc::internal::relocate<CWCImpl>(cwc_target, cwc_source); }";
+			}
+			if(default_ctor) vtable_entry{*default_ctor, inline_}.definiton(os << ",\n");
 			for(const auto & c : c.content)
 				std::visit(combined{
 					[](const comment &) {},
 					[](const attribute &) {},
 					[](const using_ &) {},
-					[&](const auto & c) { if(!c.delete_) vtable_entry{c}.definiton(os << ",\n"); }
+					[&](const constructor & c) { if(!c.delete_) vtable_entry{c, inline_}.definiton(os << ",\n"); },
+					[&](const method & m) {
+						if(m.delete_) return;
+						vtable_entry{m}.definiton(os << ",\n");
+						if(m.batch) vtable_entry{m, vtable_entry::batch_t{}}.definiton(os << ",\n");
+					}
 				}, c);
 			os << "\n";
 			os << "};\n";
@@ -307,21 +511,39 @@ namespace cwcc {
 			os << "\n";
 			os << "static\n";
 			os << "auto cwc_context() -> const cwc::internal::context &";
-			const auto mangled{mangle(ns, c.name)};
 			std::visit(combined{
 				[&](const template_ *) { os << ";\n"; },
 				[&](const library * lib) {
 					os << " {\n";
-					os << "static const cwc::internal::context instance{" << lib->name << ", \"" << mangled << "\", cwc_version};\n";
+					os << "static const cwc::internal::context instance{" << lib->name << ", \"" << mangled << "\", cwc_version, cwc_capacity};\n";
 					os << "return instance;\n";
 					os << "}\n";
 				}
 			}, ctx);
 			os << "\n";
-			os << "void * cwc_self;\n";
+			os << "static\n";
+			os << "auto cwc_probe() noexcept -> std::error_code";
+			std::visit(combined{
+				[&](const template_ *) { os << ";\n"; },
+				[&](const library * lib) {
+					os << " {\n";
+					os << "#ifdef " << direct << "\n";
+					os << "return {};\n";
+					os << "#else\n";
+					os << "return cwc::internal::context::probe(" << lib->name << ", \"" << mangled << "\", cwc_version, cwc_capacity);\n";
+					os << "#endif\n";
+					os << "}\n";
+				}
+			}, ctx);
+			os << "\n";
+			os << "void * cwc_self{nullptr};\n";
+			os << "cwc::internal::dispatch cwc_vptr;\n";
+			os << "const cwc::internal::binding * cwc_binding{nullptr};\n"; //unused in direct mode, but copied by moves
+			if(identified) os << "std::uint64_t cwc_identity{cwc::internal::context::identity()};\n"; //unlike cwc_self never reused by later instances
+			if(inline_) os << "alignas(std::max_align_t) unsigned char cwc_storage[cwc_capacity];\n";
 			os << "};\n";
 			std::visit(combined{
-				[&](const library *) { os << "#define CWC_EXPORT_" << mangled << "(cwc_impl) extern \"C\" CWC_EXPORT const auto cwc_export_" << mangled << "{cwc::internal::access<" << ns << "::" << c.name << ">::template export_<cwc_impl>()}\n"; },
+				[&](const library * lib) { os << "#define CWC_EXPORT_" << mangled << "(...) static const auto cwc_vtable_" << mangled << "{cwc::internal::access<" << ns << "::" << c.name << ">::template export_<__VA_ARGS__>()}; " << entry(mangled, lib->name) << "\n"; },
 				[](auto) {}
 			}, ctx);
 		}
@@ -340,14 +562,14 @@ namespace cwcc {
 
 		void generate_(std::ostream & os, const extern_ & e, std::string_view ns, const library & l) {
 			const auto mangled{mangle(ns, e.component, e.tparams)};
-			os << "#define CWC_EXPORT_" << mangled << "(cwc_impl) extern \"C\" CWC_EXPORT const auto cwc_export_" << mangled << "{cwc::internal::access<" << ns << "::" << e.component << "<";
+			os << "#define CWC_EXPORT_" << mangled << "(...) static const auto cwc_vtable_" << mangled << "{cwc::internal::access<" << ns << "::" << e.component << "<";
 			auto first{true}; //TODO: [C++20] merge into for-loop...
 			for(const auto & t : e.tparams) {
 				if(first) first = false;
 				else os << ", ";
 				os << t;
 			}
-			os << ">>::template export_<cwc_impl>()}\n";
+			os << ">>::template export_<__VA_ARGS__>()}; " << entry(mangled, l.name) << "\n";
 			os << "template<>\n";
 			os << "inline\n";
 			os << "auto " << e.component << "<";
@@ -358,9 +580,19 @@ namespace cwcc {
 				os << t;
 			}
 			os << ">::cwc_context() -> const cwc::internal::context & {\n";
-			os << "static const cwc::internal::context instance{" << l.name << ", \"" << mangled << "\", cwc_version};\n";
+			os << "static const cwc::internal::context instance{" << l.name << ", \"" << mangled << "\", cwc_version, cwc_capacity};\n";
 			os << "return instance;\n";
 			os << "}\n";
+			os << "template<>\n";
+			os << "inline\n";
+			os << "auto " << e.component << "<";
+			first = true; //TODO: [C++20] merge into for-loop...
+			for(const auto & t : e.tparams) {
+				if(first) first = false;
+				else os << ", ";
+				os << t;
+			}
+			os << ">::cwc_probe() noexcept -> std::error_code { return cwc::internal::context::probe(" << l.name << ", \"" << mangled << "\", cwc_version, cwc_capacity); }\n";
 		}
 
 		void generate_(std::ostream & os, const library & l, std::string_view ns) {
@@ -385,6 +617,39 @@ namespace cwcc {
 		void generate_(std::ostream & os, const include & i) {
 			os << "#include " << i.header << "\n";
 		}
+
+		void generate_exports(std::ostream & os, const cwc & c) { //lists all components of a library => a missing CWC_EXPORT_* fails to link
+			std::vector<std::pair<std::string_view, std::vector<std::string>>> libraries; //in order of declaration
+			for(const auto & c : c.content) {
+				if(!std::holds_alternative<namespace_>(c)) continue;
+				const auto & n{std::get<namespace_>(c)};
+				for(const auto & c : n.content) {
+					if(!std::holds_alternative<library>(c)) continue;
+					const auto & l{std::get<library>(c)};
+					auto it{std::find_if(libraries.begin(), libraries.end(), [&](const auto & lib) { return lib.first == l.name; })};
+					if(it == libraries.end()) it = libraries.insert(it, {l.name, {}});
+					it->second.push_back(std::visit(combined{
+						[&](const component & c) { return mangle(n.name, c.name); },
+						[&](const extern_ & e) { return mangle(n.name, e.component, e.tparams); }
+					}, l.content));
+				}
+			}
+			for(const auto & [name, components] : libraries) {
+				assert(name.size() >= 2 && name.front() == '"' && name.back() == '"');
+				os << "\n#define CWC_EXPORTS_";
+				for(const auto ch : name.substr(1, name.size() - 2)) os << (std::isalnum(static_cast<unsigned char>(ch)) ? ch : '_');
+				os << "() ";
+				for(const auto & m : components) os << declaration(m) << "; ";
+				os << "CWC_EXPORTS(";
+				auto first{true}; //TODO: [C++20] merge into for-loop...
+				for(const auto & m : components) {
+					if(first) first = false;
+					else os << ", ";
+					os << "cwc::internal::exported{cwc::internal::hash(\"" << m << "\"), &cwc_export_" << m << "}";
+				}
+				os << ")\n";
+			}
+		}
 	}
 
 	void generate(std::ostream & os, const cwc & c) {
@@ -400,5 +665,28 @@ namespace cwcc {
 			else os << "\n";
 			std::visit([&](const auto & c) { generate_(os, c); }, c);
 		}
+		generate_exports(os, c);
+	}
+
+	void generate_manifest(std::ostream & os, const cwc & c) {
+		os << "#generated with CWCC\n";
+		for(const auto & c : c.content) {
+			if(!std::holds_alternative<namespace_>(c)) continue;
+			const auto & n{std::get<namespace_>(c)};
+			for(const auto & c : n.content) {
+				if(!std::holds_alternative<library>(c)) continue;
+				const auto & l{std::get<library>(c)};
+				assert(l.name.size() >= 2 && l.name.front() == '"' && l.name.back() == '"');
+				const auto dll{l.name.substr(1, l.name.size() - 2)};
+				std::visit(combined{
+					[&](const component & c) { os << mangle(n.name, c.name) << " " << c.version << " " << dll << "\n"; },
+					[&](const extern_ & e) {
+						const auto it{std::find_if(n.content.begin(), n.content.end(), [&](const auto & c) { return std::holds_alternative<template_>(c) && std::get<template_>(c).component_.name == e.component; })};
+						if(it == n.content.end()) throw std::invalid_argument{"could not find template for extern component " + std::string{e.component}};
+						os << mangle(n.name, e.component, e.tparams) << " " << std::get<template_>(*it).component_.version << " " << dll << "\n";
+					}
+				}, l.content);
+			}
+		}
 	}
 }
@@ -8,4 +8,6 @@ namespace cwcc {
 	struct cwc;
 
 	void generate(std::ostream & os, const cwc & c);
+
+	void generate_manifest(std::ostream & os, const cwc & c);
 }
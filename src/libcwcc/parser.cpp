@@ -21,12 +21,14 @@ NAMESPACE ::= namespace NS_IDENT '{' (COMMENT | LIBRARY | TEMPLATE)* '}'
 LIBRARY ::= '@library' '(' STRING ')' (EXTERN | COMPONENT)
 EXTERN ::= 'extern' 'template' 'component' IDENT '<' TPARAM % ',' '>' ';'
 TEMPLATE ::= 'template' '<' (TYPE IDENT ) % ',' '>' COMPONENT
-COMPONENT ::= VERSION 'component' ATTRIBUTE* IDENT ['final'] '{' (ATTRIBUTE | COMMENT | CONSTRUCTOR | METHOD | USING)* '}' ';'
+COMPONENT ::= VERSION 'component' (ATTRIBUTE | STORAGE)* IDENT ['final'] '{' (ATTRIBUTE | COMMENT | CONSTRUCTOR | METHOD | USING)* '}' ';'
 CONSTRUCTOR ::= ['explicit'] IDENT '(' PARAM % ',' ')' ['=' 'delete'] ';'
-METHOD ::= ['static' ('auto' | 'void') ('operator' '(' ')' | IDENT) '(' PARAM % ',' ')' ['const'] [('&' | '&&')] ['noexcept'] ['->' TYPE] ['=' 'delete'] ';'
+METHOD ::= DIRECTIVE* ['static' ('auto' | 'void') ('operator' '(' ')' | IDENT) '(' PARAM % ',' ')' ['const'] [('&' | '&&')] ['noexcept'] ['->' TYPE] ['=' 'delete'] ';'
 PARAM ::= ((const TYPE '&') | ('const' TYPE ('&' | '&&'))) IDENT
 USING ::= 'using' IDENT '=' TYPE ';'
-ATTRIBUTE ::= '[[' IDENT ['(' STRING ')'] ']]'
+ATTRIBUTE ::= '[[' NS_IDENT ['(' STRING ')'] ']]'
+DIRECTIVE ::= '[[' ('cwc::batch' | 'cwc::pure' ['(' NUMBER ')']) ']]'
+STORAGE ::= '[[' 'cwc::inline_storage' '(' NUMBER ')' ']]'
 TYPE ::= NS_IDENT ['<' ?* '>']
 TPARAM ::= SIGNED_NUMBER | TYPE
 SIGNED_NUMBER ::= ['+' | '-'] NUMBER
@@ -5,19 +5,45 @@
 //          http://www.boost.org/LICENSE_1_0.txt)
 
 #include <any>
+#include <atomic>
 #include <regex>
 #include <future>
+#include <vector>
 #include <variant>
+#include <sstream>
 #include <optional>
+#include <stdexcept>
+#include <algorithm>
+#include <string_view>
 #include <filesystem>
 #include <functional>
 
 #include "test.cwch"
 
+namespace cwc::test {
+	struct custom_error : std::runtime_error { using std::runtime_error::runtime_error; };
+}
+
 #ifndef CWC_TEST_DLL
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
 
+#if defined(__linux__) && !defined(CWC_STATIC_REGISTRY)
+#include <link.h>
+
+namespace {
+	auto mapped(const char * library) noexcept -> bool {
+		std::pair<const char *, bool> state{library, false};
+		dl_iterate_phdr([](dl_phdr_info * info, std::size_t, void * data) {
+			auto & [library, found]{*reinterpret_cast<std::pair<const char *, bool> *>(data)};
+			found = std::string_view{info->dlpi_name}.find(library) != std::string_view::npos;
+			return found ? 1 : 0;
+		}, &state);
+		return state.second;
+	}
+}
+#endif
+
 TEST_CASE("cwc unavailable", "[context]") {
 	REQUIRE(!cwc::available<cwc::test::unavailable>());
 	REQUIRE_THROWS(cwc::test::unavailable{});
@@ -28,6 +54,490 @@ TEST_CASE("cwc available", "[context]") {
 	REQUIRE_NOTHROW(cwc::test::available{});
 }
 
+TEST_CASE("cwc probe", "[context]") {
+	REQUIRE(cwc::probe<cwc::test::unavailable>() == cwc::errc::entry_point_not_found);
+	REQUIRE(!cwc::probe<cwc::test::available>());
+	REQUIRE(cwc::make_error_code(cwc::errc::library_not_found).message() == "could not find library");
+	REQUIRE(cwc::internal::context::probe("test-cwc", "3cwc4test8outdated", 0) == cwc::errc::incompatible_layout); //vtable would be misindexed
+	REQUIRE_THROWS(cwc::internal::context{"test-cwc", "3cwc4test8outdated", 0});
+
+#ifndef CWC_STATIC_REGISTRY
+	cwc::search_paths({"missing"});
+	REQUIRE(cwc::probe<cwc::test::available>() == cwc::errc::library_not_found);
+	REQUIRE(cwc::probe<cwc::test::available>() == cwc::errc::library_not_found);
+	try {
+		cwc::internal::context{"test-cwc", "3cwc4test9available", 2};
+		FAIL("std::system_error expected");
+	} catch(const std::system_error & exc) {
+		REQUIRE(exc.code() == cwc::errc::library_not_found);
+	}
+
+	cwc::search_paths({""});
+	REQUIRE(cwc::available<cwc::test::available>());
+#endif
+	cwc::refresh();
+	REQUIRE(cwc::available<cwc::test::available>());
+	REQUIRE(!cwc::available<cwc::test::unavailable>());
+}
+
+TEST_CASE("cwc shared library", "[context]") {
+#ifndef CWC_STATIC_REGISTRY
+	const auto loads{[] { //load attempts of test-cwc recorded so far
+		std::ostringstream json;
+		cwc::load_report(json, cwc::report_format::json);
+		const auto str{json.str()};
+		std::size_t result{0};
+		for(auto pos{str.find("{\"name\":\"test-cwc\",\"path\"")}; pos != std::string::npos; pos = str.find("{\"name\":\"test-cwc\",\"path\"", pos + 1)) ++result;
+		return result;
+	}};
+	REQUIRE(cwc::release_unused() <= 1); //contexts below have to load the library again
+	cwc::record_load_statistics(true);
+	const auto before{loads()};
+#endif
+	const cwc::internal::context ctx0{"test-cwc", "3cwc4test9available", 2};
+	const cwc::internal::context ctx1{"test-cwc", "3cwc4test9available", 2};
+	const cwc::internal::context ctx2{"test-cwc", "3cwc4test7results", 0};
+#ifndef CWC_STATIC_REGISTRY
+	cwc::record_load_statistics(false);
+	REQUIRE(loads() == before + 1); //all contexts share a single handle of the library
+#endif
+	REQUIRE_THROWS(cwc::internal::context{"test-cwc", "3cwc4test11unavailable", 1});
+	REQUIRE_THROWS(cwc::internal::context{"test-cwc", "3cwc4test9available", 3});
+	REQUIRE_THROWS(cwc::internal::context{"unavailable", "3cwc4test9available", 2});
+}
+
+#ifndef CWC_STATIC_REGISTRY
+TEST_CASE("cwc release unused", "[context]") {
+	{
+		cwc::test::available a;
+		REQUIRE(cwc::release_unused() == 0); //live instance keeps library loaded
+		REQUIRE_NOTHROW(a(0));
+	}
+	REQUIRE(cwc::release_unused() == 1);
+	REQUIRE(cwc::release_unused() == 0);
+#ifdef __linux__
+	REQUIRE(!mapped("libtest-cwc.so"));
+#endif
+
+	{
+		cwc::test::available a; //library is transparently reloaded
+#ifdef __linux__
+		REQUIRE(mapped("libtest-cwc.so"));
+#endif
+		auto b{std::move(a)};
+		{ const auto c{std::move(b)}; }
+		REQUIRE(cwc::release_unused() == 1);
+	} //destroying moved-from instances must not touch the unloaded library
+
+#ifdef __linux__
+	{
+		const auto failed{[] { return cwc::test::results{}.try_check(-1); }()};
+		REQUIRE(cwc::release_unused() == 1);
+		REQUIRE(mapped("libtest-cwc.so")); //forwarded exception refers to the library
+		REQUIRE(failed.error().what() == std::string_view{"negative value"}); //rethrowing would keep the library loaded for good
+	}
+	REQUIRE(!mapped("libtest-cwc.so"));
+#endif
+
+	{
+		const cwc::test::results r; //reloaded into the recycled image, available is not bound to it yet
+		cwc::test::available a;
+		REQUIRE_NOTHROW(a(0));
+	}
+	REQUIRE(cwc::release_unused() == 1);
+
+#ifdef __linux__
+	{
+		const auto directory{std::filesystem::read_symlink("/proc/self/exe").parent_path()};
+		std::filesystem::copy_file(directory / "libtest-cwc.so", directory / "libtest-cwc-unwinding.so", std::filesystem::copy_options::overwrite_existing);
+		cwc::hot_swap("test-cwc", "libtest-cwc-unwinding.so"); //rethrowing keeps the build loaded for good
+		try {
+			cwc::test::results{}.check(-1);
+			FAIL("cwc::test::custom_error expected");
+		} catch(const cwc::test::custom_error & exc) {
+			REQUIRE(cwc::release_unused() == 1);
+			REQUIRE(mapped("libtest-cwc-unwinding.so")); //exception in flight refers to the library
+			REQUIRE(exc.what() == std::string_view{"negative value"});
+		}
+		cwc::hot_swap("test-cwc", "libtest-cwc.so");
+		std::filesystem::remove(directory / "libtest-cwc-unwinding.so");
+	}
+#endif
+
+	cwc::test::available a;
+	REQUIRE_NOTHROW(a(0));
+}
+
+TEST_CASE("cwc load policy", "[context]") {
+	cwc::release_unused();
+	REQUIRE(cwc::test::warmup::invocations() == 0);
+	REQUIRE(cwc::release_unused() == 1);
+
+	cwc::set_load_policy(cwc::load_policy::lock | cwc::load_policy::warmup);
+	REQUIRE(cwc::test::warmup::invocations() == 1);
+	REQUIRE(cwc::release_unused() == 1);
+
+	cwc::set_load_policy(cwc::load_policy::prefault);
+	REQUIRE(cwc::test::warmup::invocations() == 0);
+	cwc::set_load_policy(cwc::load_policy::lazy);
+}
+#else
+TEST_CASE("cwc static registry", "[context]") {
+	REQUIRE_NOTHROW(cwc::internal::context{"test-cwc", "3cwc4test9available", 2});
+	REQUIRE(!cwc::probe<cwc::test::warmup>());
+	REQUIRE(cwc::probe<cwc::test::unavailable>() == cwc::errc::entry_point_not_found);
+	try {
+		cwc::internal::context{"other", "3cwc4test9available", 2};
+		FAIL("std::system_error expected");
+	} catch(const std::system_error & exc) {
+		REQUIRE(exc.code() == cwc::errc::library_not_found);
+	}
+
+	{
+		const cwc::test::available a;
+		REQUIRE(cwc::release_unused() == 0);
+	}
+	REQUIRE(cwc::release_unused() == 0); //nothing to unload
+	REQUIRE_THROWS_AS(cwc::hot_swap("test-cwc", "replacement"), std::system_error);
+
+	cwc::set_load_policy(cwc::load_policy::warmup);
+	REQUIRE(cwc::test::warmup::invocations() == 0);
+	cwc::set_load_policy(cwc::load_policy::lazy);
+}
+#endif
+
+TEST_CASE("cwc preload", "[context]") {
+	REQUIRE_NOTHROW(cwc::preload<cwc::test::available>());
+	REQUIRE_NOTHROW(cwc::preload({"test-cwc"}));
+	REQUIRE_NOTHROW(cwc::preload_async<cwc::test::available>().get());
+
+	try {
+		cwc::preload<cwc::test::unavailable, cwc::test::available, cwc::test::unavailable>();
+		FAIL("preload_error expected");
+	} catch(const cwc::preload_error & exc) {
+		REQUIRE(exc.failures().size() == 2);
+		REQUIRE(exc.failures()[0].index == 0);
+		REQUIRE(exc.failures()[1].index == 2);
+		REQUIRE_THROWS_AS(std::rethrow_exception(exc.failures()[0].error), std::runtime_error);
+	}
+	REQUIRE_THROWS_AS(cwc::preload_async({"test-cwc", "unavailable"}).get(), cwc::preload_error);
+}
+
+TEST_CASE("cwc load statistics", "[context]") {
+	cwc::refresh(); //libraries that were not found before are cached
+	cwc::record_load_statistics(true);
+	REQUIRE_THROWS(cwc::internal::context{"unavailable", "3cwc4test9available", 2});
+	REQUIRE_NOTHROW(cwc::internal::context{"test-cwc", "3cwc4test9available", 2});
+	REQUIRE_THROWS(cwc::internal::context{"test-cwc", "3cwc4test9available", 3});
+	cwc::record_load_statistics(false);
+	REQUIRE_THROWS(cwc::internal::context{"test-cwc", "3cwc4test11unavailable", 1});
+
+	std::ostringstream text;
+	cwc::load_report(text, cwc::report_format::text);
+	REQUIRE(text.str().find("3cwc4test9available") != std::string::npos);
+	REQUIRE(text.str().find("version mismatch") != std::string::npos);
+	REQUIRE(text.str().find("3cwc4test11unavailable") == std::string::npos);
+
+	std::ostringstream json;
+	cwc::load_report(json, cwc::report_format::json);
+	REQUIRE(json.str().find("{\"name\":\"unavailable\"") != std::string::npos);
+	REQUIRE(json.str().find("\"status\":\"not found\"") != std::string::npos);
+	REQUIRE(json.str().find("\"status\":\"ok\"") != std::string::npos);
+}
+
+#if defined(__linux__) && !defined(CWC_STATIC_REGISTRY)
+TEST_CASE("cwc hot swap", "[context]") {
+	const auto directory{std::filesystem::read_symlink("/proc/self/exe").parent_path()};
+	std::filesystem::copy_file(directory / "libtest-cwc.so", directory / "libtest-cwc-swapped.so", std::filesystem::copy_options::overwrite_existing);
+	REQUIRE_THROWS_AS(cwc::hot_swap("test-cwc", "libtest-cwc-missing.so"), std::system_error);
+	const auto foreign{[] { //any library without export table
+		std::string result;
+		dl_iterate_phdr([](dl_phdr_info * info, std::size_t, void * data) {
+			if(std::string_view{info->dlpi_name}.find("libc.so") == std::string_view::npos) return 0;
+			*reinterpret_cast<std::string *>(data) = info->dlpi_name;
+			return 1;
+		}, &result);
+		return result;
+	}()};
+	try {
+		cwc::hot_swap("test-cwc", foreign);
+		FAIL("std::system_error expected");
+	} catch(const std::system_error & exc) {
+		REQUIRE(exc.code() == cwc::errc::incompatible_layout); //rejected at load time
+	}
+
+	{
+		cwc::test::available before;
+		const auto origin{cwc::test::memoized::origin()};
+		REQUIRE(cwc::test::memoized::origin() == origin);
+		REQUIRE_NOTHROW(cwc::hot_swap("test-cwc", "libtest-cwc-swapped.so"));
+		REQUIRE(mapped("libtest-cwc-swapped.so"));
+		REQUIRE(cwc::test::memoized::origin() != origin); //memoized results of the previous build are stale
+		cwc::test::available after;
+		REQUIRE(cwc::release_unused() == 0); //both builds still have instances
+		REQUIRE_NOTHROW(before(0));
+		REQUIRE_NOTHROW(after(0));
+
+		{ const auto drained{std::move(before)}; }
+		REQUIRE(cwc::release_unused() == 1);
+		REQUIRE(!mapped("libtest-cwc.so"));
+		REQUIRE_NOTHROW(after(0));
+	}
+	REQUIRE(mapped("libtest-cwc-swapped.so")); //preloaded libraries remain loaded
+	std::filesystem::remove(directory / "libtest-cwc-swapped.so");
+}
+
+TEST_CASE("cwc library variants", "[context]") {
+	const auto directory{std::filesystem::read_symlink("/proc/self/exe").parent_path()};
+	std::filesystem::copy_file(directory / "libtest-cwc.so", directory / "libtest-cwc.test-variant.so", std::filesystem::copy_options::overwrite_existing);
+	const auto detected{cwc::library_variants()};
+
+	cwc::library_variants({"missing-variant"});
+	REQUIRE_NOTHROW(cwc::preload({"test-cwc"})); //falls back to baseline
+	REQUIRE(!mapped("libtest-cwc.missing-variant.so"));
+	REQUIRE(!mapped("libtest-cwc.test-variant.so"));
+
+	cwc::library_variants({"missing-variant", "test-variant"});
+	REQUIRE_NOTHROW(cwc::preload({"test-cwc"}));
+	REQUIRE(mapped("libtest-cwc.test-variant.so"));
+
+	cwc::library_variants(detected);
+	REQUIRE(cwc::library_variants() == detected);
+	std::filesystem::remove(directory / "libtest-cwc.test-variant.so");
+}
+#endif
+
+#ifndef CWC_STATIC_REGISTRY
+TEST_CASE("cwc manifest", "[context]") { //listed libraries take precedence over their variants => after testing variants
+	REQUIRE_THROWS(cwc::load_manifest("missing.manifest"));
+
+	cwc::search_paths({"missing"});
+	REQUIRE_THROWS(cwc::internal::context{"test-cwc", "3cwc4test9available", 2});
+	REQUIRE_NOTHROW(cwc::load_manifest("test-cwc.manifest"));
+	REQUIRE_NOTHROW(cwc::internal::context{"test-cwc", "3cwc4test9available", 2});
+	REQUIRE_THROWS(cwc::internal::context{"test-cwc", "3cwc4test9available", 3});
+
+	REQUIRE_NOTHROW(cwc::preload({"test-cwc"})); //libraries are looked up in the manifest as well
+
+	cwc::search_paths({""});
+}
+#endif
+
+TEST_CASE("cwc results", "[results]") {
+	const cwc::test::results r;
+	const auto move_only{r.move_only(1)};
+	REQUIRE(move_only);
+	REQUIRE(*move_only == 1);
+	const auto move_only_throwing{r.move_only_throwing(2)};
+	REQUIRE(move_only_throwing);
+	REQUIRE(*move_only_throwing == 2);
+	REQUIRE_THROWS_AS(r.move_only_throwing(-1), std::invalid_argument);
+	const auto non_movable{r.non_movable(3)}; //constructed in place
+	REQUIRE(non_movable == 3);
+}
+
+TEST_CASE("cwc parameters", "[parameters]") {
+	static_assert(std::is_same_v<cwc::internal::param_t<int>, int>);
+	static_assert(std::is_same_v<cwc::internal::param_t<std::string>, std::string *>);
+	static_assert(std::is_same_v<cwc::internal::param_t<const std::string>, const std::string *>);
+
+	struct counted final {
+		int & moves;
+		counted(int & moves) noexcept : moves{moves} {}
+		counted(const counted & other) noexcept : moves{other.moves} {}
+		counted(counted && other) noexcept : moves{other.moves} { ++moves; }
+	};
+	int moves{0};
+	counted param{moves};
+	auto passed{cwc::internal::pass(param)}; //what the caller puts into the vtable entry
+	const counted taken{cwc::internal::take<counted>(passed)}; //what the callee passes to the implementation
+	REQUIRE(moves == 1);
+
+	const cwc::test::results r;
+	REQUIRE(r.concat(std::string(64, 'a'), std::string(64, 'b')) == std::string(64, 'a') + std::string(64, 'b'));
+}
+
+TEST_CASE("cwc batch", "[results]") {
+	const cwc::test::batches b;
+	const std::vector<int> in{1, 2, 3, -4, 5};
+	std::vector<int> out(in.size());
+	b.square(cwc::span<const int>{in.data(), 3}, out);
+	REQUIRE(out == std::vector<int>{1, 4, 9, 0, 0});
+	REQUIRE_THROWS_AS(b.square(in, out), std::invalid_argument); //reported for the whole batch
+	REQUIRE(out == std::vector<int>{1, 4, 9, 0, 0}); //elements before the failing one are written
+	const auto failed{b.try_square(in, out)};
+	REQUIRE(!failed);
+	REQUIRE(std::string_view{failed.error().what()} == "negative value");
+	REQUIRE_THROWS_AS(b.square(in, cwc::span<int>{out.data(), 3}), std::length_error); //fewer results than parameters
+	const auto mismatched{b.try_square(in, cwc::span<int>{out.data(), 3})};
+	REQUIRE(!mismatched);
+	REQUIRE_THROWS_AS(mismatched.error().rethrow(), std::length_error);
+
+	const std::string strings_in[]{"a", "bc"};
+	std::string strings_out[2];
+	REQUIRE_THROWS_AS(b.twice(strings_in, cwc::span<std::string>{strings_out, 1}), std::length_error); //rejected before the kernel is invoked
+	b.twice(strings_in, strings_out);
+	REQUIRE(strings_out[0] == "aa");
+	REQUIRE(strings_out[1] == "bcbc");
+	REQUIRE(b.twice("d") == "dd");
+	REQUIRE(b.kernel_calls() == 1);
+}
+
+TEST_CASE("cwc pure", "[results]") {
+	using cwc::test::memoized;
+	const memoized m;
+	const auto invocations{memoized::invocations()};
+	REQUIRE(m.square(2) == 4);
+	REQUIRE(m.square(2) == 4);
+	REQUIRE(memoized::invocations() == invocations + 1);
+
+	REQUIRE(m.square(3) == 9);
+	REQUIRE(m.square(4) == 16); //evicts least recently used result of 2
+	REQUIRE(m.square(3) == 9);
+	REQUIRE(memoized::invocations() == invocations + 3);
+	REQUIRE(m.square(2) == 4);
+	REQUIRE(memoized::invocations() == invocations + 4);
+
+	REQUIRE_THROWS_AS(m.square(-1), std::invalid_argument);
+	REQUIRE_THROWS_AS(m.square(-1), std::invalid_argument); //failures are not memoized
+	REQUIRE(memoized::invocations() == invocations + 6);
+
+	REQUIRE(std::async(std::launch::async, [&] { return m.square(2); }).get() == 4); //every thread has its own results
+	REQUIRE(memoized::invocations() == invocations + 7);
+
+	cwc::refresh(); //libraries may have changed
+	REQUIRE(m.square(2) == 4);
+	REQUIRE(memoized::invocations() == invocations + 8);
+
+	REQUIRE(memoized::answer() == 42);
+	REQUIRE(memoized::answer() == 42); //cached once
+	REQUIRE(memoized::invocations() == invocations + 9);
+
+	memoized one{1};
+	const memoized two{2};
+	REQUIRE(one.shifted(1) == 2);
+	REQUIRE(two.shifted(1) == 3); //every instance has its own results
+	REQUIRE(one.shifted(1) == 2);
+	REQUIRE(memoized::invocations() == invocations + 11);
+	REQUIRE(memoized{1}.shifted(1) == 2); //not shared with later instances
+	const auto moved{std::move(one)};
+	REQUIRE(moved.shifted(1) == 2); //moved along with the implementation
+	REQUIRE(memoized::invocations() == invocations + 12);
+}
+
+TEST_CASE("cwc stateless", "[context]") {
+	cwc::test::stateless a;
+	const cwc::test::stateless b;
+	REQUIRE(a.address() == b.address()); //no storage is allocated per instance
+	auto c{std::move(a)};
+	REQUIRE(c.address() == b.address());
+
+	const cwc::test::stateful d, e;
+	REQUIRE(d.address() != e.address());
+}
+
+TEST_CASE("cwc inline storage", "[context]") {
+	const auto inside{[](const auto & handle) { //implementation is stored in the handle
+		const auto address{handle.address()};
+		return address >= reinterpret_cast<std::uintptr_t>(&handle) && address < reinterpret_cast<std::uintptr_t>(&handle + 1);
+	}};
+
+	using cwc::test::inlined;
+	const auto instances{inlined::instances()};
+	{
+		inlined a{1};
+		REQUIRE(inside(a));
+		REQUIRE(inlined::instances() == instances + 1);
+
+		inlined b{std::move(a)}; //implementation is relocated along with the handle
+		REQUIRE(inside(b));
+		REQUIRE(b.value() == 1);
+		REQUIRE(inlined::instances() == instances + 1);
+
+		inlined c{2};
+		c = std::move(b);
+		REQUIRE(inside(c));
+		REQUIRE(c.value() == 1);
+		REQUIRE(inlined::instances() == instances + 1);
+	}
+	REQUIRE(inlined::instances() == instances);
+
+	cwc::test::spilled d{3}; //too large for the storage of the handle => allocated on the heap
+	REQUIRE(!inside(d));
+	const auto e{std::move(d)};
+	REQUIRE(e.value() == 3);
+
+	REQUIRE(!cwc::probe<inlined>());
+	REQUIRE(cwc::internal::context::probe("test-cwc", "3cwc4test7inlined", 0) == cwc::errc::incompatible_layout); //handle without storage expects no entries to destroy and relocate
+	REQUIRE(cwc::internal::context::probe("test-cwc", "3cwc4test9available", 2, 32) == cwc::errc::incompatible_layout);
+}
+
+TEST_CASE("cwc pool allocation", "[context]") {
+	using cwc::test::pooled;
+	{
+		std::vector<pooled> instances(3);
+		REQUIRE(instances.back().value() == 42);
+		const auto s{pooled::statistics()};
+		REQUIRE(s.live == 3);
+	}
+	auto s{pooled::statistics()};
+	REQUIRE(s.live == 0);
+	REQUIRE(s.cached == 2); //high water mark, surplus is returned to the system
+	REQUIRE(s.allocated - s.released == 2);
+
+	const auto allocated{s.allocated};
+	{
+		const pooled a, b;
+		s = pooled::statistics();
+		REQUIRE(s.cached == 0);
+		REQUIRE(s.allocated == allocated); //recycled
+	}
+	REQUIRE(pooled::statistics().cached == 2);
+}
+
+TEST_CASE("cwc expected", "[exceptions]") {
+	constexpr
+	std::uint64_t invalid_argument{0x0101010000000000}, runtime_error{0x0102000000000000};
+
+	const cwc::test::results r;
+	auto in_memory{r.try_move_only_throwing(1)};
+	REQUIRE(in_memory);
+	REQUIRE(**in_memory == 1);
+	in_memory = r.try_move_only_throwing(-1);
+	REQUIRE(!in_memory);
+	REQUIRE(in_memory.error().code() == invalid_argument);
+	REQUIRE(std::string_view{in_memory.error().what()} == "negative value");
+	REQUIRE_THROWS_AS(in_memory.value(), std::invalid_argument);
+
+	const auto in_registers{r.try_checked(2)};
+	REQUIRE(in_registers.has_value());
+	REQUIRE(in_registers.value() == 2);
+	const auto failed{r.try_checked(-2)};
+	REQUIRE(!failed);
+	REQUIRE(failed.error().code() == runtime_error);
+	REQUIRE_THROWS_AS(failed.error().rethrow(), cwc::test::custom_error); //same toolset => forwarded as is
+
+	REQUIRE(r.try_check(3));
+	const auto void_failed{r.try_check(-3)};
+	REQUIRE(!void_failed);
+	REQUIRE(std::string_view{void_failed.error().what()} == "negative value");
+	REQUIRE_THROWS_AS(void_failed.value(), cwc::test::custom_error);
+
+	cwc::internal::call_context<void, false> portable{false}; //mixed toolsets => mapped to the closest standard exception
+	portable.try_([] { throw cwc::test::custom_error{"custom"}; });
+	const auto mapped{portable.expect()};
+	REQUIRE(!mapped);
+	REQUIRE(mapped.error().code() == runtime_error);
+	REQUIRE(std::string_view{mapped.error().what()} == "custom");
+	try {
+		mapped.value();
+		FAIL("std::runtime_error expected");
+	} catch(const std::runtime_error & exc) {
+		REQUIRE(dynamic_cast<const cwc::test::custom_error *>(&exc) == nullptr);
+		REQUIRE(std::string_view{exc.what()} == "custom");
+	}
+}
+
 TEST_CASE("cwc exceptions", "[exceptions]") { //TODO: future_error, regex_error, ios::failure___stream
 	cwc::test::available a;
 	REQUIRE_NOTHROW(a(0));
@@ -53,6 +563,18 @@ TEST_CASE("cwc exceptions", "[exceptions]") { //TODO: future_error, regex_error,
 	REQUIRE_THROWS_AS(a(20), std::logic_error);
 	REQUIRE_THROWS_AS(a(21), std::exception);
 	REQUIRE_THROWS_AS(a(22), std::exception);
+	REQUIRE_THROWS_AS(a(23), cwc::test::custom_error); //same toolset => forwarded as is
+	REQUIRE_THROWS_WITH(a(23), "custom");
+
+	cwc::internal::call_context<void, false> portable{false}; //mixed toolsets => mapped to the closest standard exception
+	portable.try_([] { throw cwc::test::custom_error{"custom"}; });
+	try {
+		portable.return_();
+		FAIL("std::runtime_error expected");
+	} catch(const std::runtime_error & exc) {
+		REQUIRE(dynamic_cast<const cwc::test::custom_error *>(&exc) == nullptr);
+		REQUIRE(std::string_view{exc.what()} == "custom");
+	}
 }
 
 #else
@@ -82,10 +604,158 @@ namespace {
 				case 20: throw std::logic_error{""};
 				case 21: throw std::exception{};
 				case 22: throw 0;
+				case 23: throw cwc::test::custom_error{"custom"};
 			}
 		}
 	};
 }
 
+namespace {
+	std::atomic<int> warmups{0};
+
+	void warmup() noexcept { ++warmups; }
+
+	struct warmup_impl final {
+		static
+		auto invocations() noexcept -> int { return warmups; }
+	};
+
+	struct results_impl final {
+		auto move_only(int value) const noexcept -> std::unique_ptr<int> { return std::make_unique<int>(value); }
+		auto move_only_throwing(int value) const -> std::unique_ptr<int> {
+			if(value < 0) throw std::invalid_argument{"negative value"};
+			return std::make_unique<int>(value);
+		}
+		auto non_movable(int value) const noexcept -> std::atomic<int> { return std::atomic<int>{value}; }
+		auto concat(std::string lhs, std::string rhs) const -> std::string { return lhs + rhs; }
+		auto checked(int value) const -> int {
+			check(value);
+			return value;
+		}
+		void check(int value) const { if(value < 0) throw cwc::test::custom_error{"negative value"}; }
+	};
+
+	struct batches_impl final {
+		mutable int kernels{0};
+
+		auto square(int value) const -> int { //batches use the default adapter
+			if(value < 0) throw std::invalid_argument{"negative value"};
+			return value * value;
+		}
+
+		auto twice(const std::string & value) const noexcept -> std::string { return value + value; }
+		void twice(cwc::span<const std::string> in, cwc::span<std::string> out) const noexcept { //dedicated kernel
+			++kernels;
+			std::transform(in.begin(), in.end(), out.begin(), [&](const std::string & value) { return twice(value); });
+		}
+
+		auto kernel_calls() const noexcept -> int { return kernels; }
+	};
+
+	std::atomic<int> memoized_invocations{0};
+
+	struct memoized_impl final {
+		int offset{0};
+
+		memoized_impl() =default;
+		explicit
+		memoized_impl(int offset) noexcept : offset{offset} {}
+
+		auto square(int value) const -> int {
+			++memoized_invocations;
+			if(value < 0) throw std::invalid_argument{"negative value"};
+			return value * value;
+		}
+
+		auto shifted(int value) const noexcept -> int {
+			++memoized_invocations;
+			return value + offset;
+		}
+
+		static
+		auto answer() noexcept -> int {
+			++memoized_invocations;
+			return 42;
+		}
+
+		static
+		auto origin() noexcept -> std::uintptr_t { return reinterpret_cast<std::uintptr_t>(&memoized_invocations); }
+
+		static
+		auto invocations() noexcept -> int { return memoized_invocations; }
+	};
+
+	struct stateless_impl final {
+		auto address() const noexcept -> std::uintptr_t { return reinterpret_cast<std::uintptr_t>(this); }
+	};
+	static_assert(cwc::internal::stateless_v<stateless_impl>);
+
+	struct stateful_impl final {
+		int state{0};
+
+		auto address() const noexcept -> std::uintptr_t { return reinterpret_cast<std::uintptr_t>(this); }
+	};
+	static_assert(!cwc::internal::stateless_v<stateful_impl>);
+
+	std::atomic<int> inlined_instances{0};
+
+	struct inlined_impl final {
+		int value_;
+
+		explicit
+		inlined_impl(int value) noexcept : value_{value} { ++inlined_instances; }
+		inlined_impl(inlined_impl && other) noexcept : value_{other.value_} { ++inlined_instances; }
+		~inlined_impl() noexcept { --inlined_instances; }
+
+		auto value() const noexcept -> int { return value_; }
+		auto address() const noexcept -> std::uintptr_t { return reinterpret_cast<std::uintptr_t>(this); }
+
+		static
+		auto instances() noexcept -> int { return inlined_instances; }
+	};
+
+	using pooled_allocation = cwc::pool_allocation<2>;
+
+	struct pooled_impl final {
+		int value_{42};
+
+		auto value() const noexcept -> int { return value_; }
+
+		static
+		auto statistics() noexcept -> cwc::pool_statistics { return pooled_allocation::statistics<pooled_impl>(); }
+	};
+
+	struct outdated_header final { //as emitted by libraries built against hversion 1
+		std::uint8_t hversion{1}, size{16}, cversion{0}, features{0};
+		std::uint32_t toolset{0}, isize{0}, ialign{0};
+	};
+}
+
+static const outdated_header cwc_vtable_3cwc4test8outdated{};
+static const cwc::internal::export_entry cwc_export_3cwc4test8outdated{"3cwc4test8outdated", "test-cwc", &cwc_vtable_3cwc4test8outdated};
+
 CWC_EXPORT_3cwc4test9available(impl);
+CWC_EXPORT_3cwc4test6warmup(warmup_impl);
+CWC_EXPORT_3cwc4test7results(results_impl);
+CWC_EXPORT_3cwc4test7batches(batches_impl);
+CWC_EXPORT_3cwc4test8memoized(memoized_impl);
+CWC_EXPORT_3cwc4test9stateless(stateless_impl);
+CWC_EXPORT_3cwc4test8stateful(stateful_impl);
+CWC_EXPORT_3cwc4test7inlined(inlined_impl);
+CWC_EXPORT_3cwc4test7spilled(inlined_impl);
+CWC_EXPORT_3cwc4test6pooled(pooled_impl, pooled_allocation);
+CWC_EXPORTS( //listed manually as unavailable is intentionally not exported
+	cwc::internal::exported{cwc::internal::hash("3cwc4test9available"), &cwc_export_3cwc4test9available},
+	cwc::internal::exported{cwc::internal::hash("3cwc4test6warmup"), &cwc_export_3cwc4test6warmup},
+	cwc::internal::exported{cwc::internal::hash("3cwc4test7results"), &cwc_export_3cwc4test7results},
+	cwc::internal::exported{cwc::internal::hash("3cwc4test7batches"), &cwc_export_3cwc4test7batches},
+	cwc::internal::exported{cwc::internal::hash("3cwc4test8memoized"), &cwc_export_3cwc4test8memoized},
+	cwc::internal::exported{cwc::internal::hash("3cwc4test9stateless"), &cwc_export_3cwc4test9stateless},
+	cwc::internal::exported{cwc::internal::hash("3cwc4test8stateful"), &cwc_export_3cwc4test8stateful},
+	cwc::internal::exported{cwc::internal::hash("3cwc4test7inlined"), &cwc_export_3cwc4test7inlined},
+	cwc::internal::exported{cwc::internal::hash("3cwc4test7spilled"), &cwc_export_3cwc4test7spilled},
+	cwc::internal::exported{cwc::internal::hash("3cwc4test6pooled"), &cwc_export_3cwc4test6pooled},
+	cwc::internal::exported{cwc::internal::hash("3cwc4test8outdated"), &cwc_export_3cwc4test8outdated}
+);
+CWC_WARMUP(warmup);
 #endif
@@ -0,0 +1,146 @@
+//          Copyright Michael Florian Hava.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file ../../LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+#include <sstream>
+#include <catch.hpp>
+#include "ast.hpp"
+#include "parser.hpp"
+#include "generator.hpp"
+
+TEST_CASE("generating_manifest", "[generating] [manifest]") {
+	auto manifest{[](const char * str) {
+		cwcc::cwc c;
+		cwcc::parser p{str};
+		c.parse(p);
+		std::ostringstream os;
+		cwcc::generate_manifest(os, c);
+		return os.str();
+	}};
+
+	REQUIRE(manifest("namespace a::b { @library(\"c\") @version(0) component d {}; }") == "#generated with CWCC\n1a1b1d 0 c\n");
+	REQUIRE(manifest("namespace a { @library(\"b/c\") @version(1) component d {}; @library(\"e\") @version(2) component f {}; }") == "#generated with CWCC\n1a1d 1 b/c\n1a1f 2 e\n");
+	REQUIRE(manifest("namespace a { template<typename T> @version(3) component b {}; @library(\"c\") extern template component b<int>; }") == "#generated with CWCC\n1a1bT3intE 3 c\n");
+
+	REQUIRE_THROWS(manifest("namespace a { @library(\"c\") extern template component b<int>; }"));
+}
+
+TEST_CASE("generating_direct", "[generating]") {
+	auto generate{[](const char * str) {
+		cwcc::cwc c;
+		cwcc::parser p{str};
+		c.parse(p);
+		std::ostringstream os;
+		cwcc::generate(os, c);
+		return os.str();
+	}};
+
+	const auto direct{generate("namespace a { @library(\"b\") @version(0) component c { auto d() const noexcept -> int; }; }")};
+	REQUIRE(direct.find("#ifdef CWC_DIRECT_1a1c\n") != std::string::npos);
+	REQUIRE(direct.find("cwc_self = cwc::internal::create<CWC_DIRECT_1a1c>()") != std::string::npos);
+	REQUIRE(direct.find("cwc::internal::self<const CWC_DIRECT_1a1c>(cwc_self)->d()") != std::string::npos);
+	REQUIRE(direct.find("void * cwc_self{nullptr};\ncwc::internal::dispatch cwc_vptr;\nconst cwc::internal::binding * cwc_binding{nullptr};\n") != std::string::npos); //moves copy all members
+
+	REQUIRE(generate("namespace a { template<typename T> @version(0) component b {}; @library(\"c\") extern template component b<int>; }").find("CWC_DIRECT_") == std::string::npos);
+}
+
+TEST_CASE("generating_results", "[generating]") {
+	cwcc::cwc c;
+	cwcc::parser p{"namespace a { @library(\"b\") @version(0) component c { auto d() const noexcept -> int; auto e(int f) -> int; static auto g(int h) noexcept -> int; }; }"};
+	c.parse(p);
+	std::ostringstream os;
+	cwcc::generate(os, c);
+	const auto result{os.str()};
+
+	REQUIRE(result.find("int(*cwc_2)(const void *) noexcept;") != std::string::npos); //noexcept => returned in place
+	REQUIRE(result.find("cwc::internal::returned_t<int>(*cwc_3)(cwc::internal::call_context<int, false> *, void *, cwc::internal::param_t<int>) noexcept;") != std::string::npos);
+	REQUIRE(result.find("int(*cwc_4)(cwc::internal::param_t<int>) noexcept;") != std::string::npos);
+}
+
+TEST_CASE("generating_batch", "[generating]") {
+	cwcc::cwc c;
+	cwcc::parser p{"namespace a { @library(\"b\") @version(0) component c { [[nodiscard]] [[cwc::batch]] auto d(int e) const -> long; auto f() noexcept -> int; }; }"};
+	c.parse(p);
+	std::ostringstream os;
+	cwcc::generate(os, c);
+	const auto result{os.str()};
+
+	REQUIRE(result.find("[[cwc::") == std::string::npos); //directives are not emitted
+	REQUIRE(result.find("[[nodiscard]]\nauto d(int e) const -> long ") != std::string::npos);
+	REQUIRE(result.find("void d(cwc::span<const int> cwc_in, cwc::span<long> cwc_out) const {\ncwc::internal::check_batch(cwc_in, cwc_out);\n") != std::string::npos);
+	REQUIRE(result.find("auto try_d(cwc::span<const int> cwc_in, cwc::span<long> cwc_out) const -> cwc::expected<void> {\ntry { cwc::internal::check_batch(cwc_in, cwc_out); } catch(...) { return {cwc::unexpect, cwc::internal::exception::current()}; }\n") != std::string::npos); //reported instead of thrown
+	REQUIRE(result.find("void(*cwc_3)(cwc::internal::call_context<void, false> *, const void *, cwc::internal::param_t<cwc::span<const int>>, cwc::internal::param_t<cwc::span<long>>) noexcept;") != std::string::npos); //directly after the scalar entry
+	REQUIRE(result.find("int(*cwc_4)(void *) noexcept;") != std::string::npos);
+	REQUIRE(result.find("cwc_ctx->try_([&] { cwc::internal::batch(*cwc::internal::self<const CWCImpl>(cwc_self), cwc_in, cwc_out, ") != std::string::npos);
+}
+
+TEST_CASE("generating_pure", "[generating]") {
+	cwcc::cwc c;
+	cwcc::parser p{"namespace a { @library(\"b\") @version(0) component c { [[cwc::pure(4)]] auto d(int e, const std::string & f) const -> long; [[cwc::pure]] static auto g() noexcept -> int; }; }"};
+	c.parse(p);
+	std::ostringstream os;
+	cwcc::generate(os, c);
+	const auto result{os.str()};
+
+	REQUIRE(result.find("thread_local cwc::internal::memo<long, std::uint64_t, int, std::string> cwc_memo{4};\nreturn cwc_memo.get([&] { return cwc_vptr.call<&cwc_vtable::cwc_2>(cwc_self, cwc::internal::pass(e), std::addressof(f)); }, cwc_identity, e, f);") != std::string::npos); //keyed by instance
+	REQUIRE(result.find("cwc_binding{cwc_other.cwc_binding}, cwc_identity{cwc_other.cwc_identity} {") != std::string::npos);
+	REQUIRE(result.find("std::uint64_t cwc_identity{cwc::internal::context::identity()};\n") != std::string::npos);
+	REQUIRE(result.find("thread_local cwc::internal::memo<int> cwc_memo{};\nreturn cwc_memo.get([&] { return cwc_context().call_static<&cwc_vtable::cwc_3>(); });") != std::string::npos); //flushed when libraries are replaced
+	REQUIRE(result.find("#ifdef CWC_DIRECT_1a1c\nreturn cwc::internal::self<const CWC_DIRECT_1a1c>(cwc_self)->d(std::move(e), f);") != std::string::npos); //linked in => not memoized
+}
+
+TEST_CASE("generating_try", "[generating]") {
+	cwcc::cwc c;
+	cwcc::parser p{"namespace a { @library(\"b\") @version(0) component c { auto d() const noexcept -> int; auto e(int f) -> int; static void g(); void operator()(); }; }"};
+	c.parse(p);
+	std::ostringstream os;
+	cwcc::generate(os, c);
+	const auto result{os.str()};
+
+	REQUIRE(result.find("try_d") == std::string::npos); //noexcept => nothing to report
+	REQUIRE(result.find("auto try_e(int f) -> cwc::expected<int> ") != std::string::npos);
+	REQUIRE(result.find("return cwc_vptr.try_call<&cwc_vtable::cwc_3>(cwc_self, cwc::internal::pass(f));") != std::string::npos);
+	REQUIRE(result.find("static\nauto try_g() -> cwc::expected<void> ") != std::string::npos);
+	REQUIRE(result.find("return cwc_context().try_call_static<&cwc_vtable::cwc_4>();") != std::string::npos);
+	REQUIRE(result.find("auto try_operator_call() -> cwc::expected<void> ") != std::string::npos);
+	REQUIRE(result.find("return cwc_vptr.try_call<&cwc_vtable::cwc_5>(cwc_self);") != std::string::npos);
+}
+
+TEST_CASE("generating_inline_storage", "[generating]") {
+	cwcc::cwc c;
+	cwcc::parser p{"namespace a { @library(\"b\") @version(0) component [[cwc::inline_storage(24)]] c { c(int d); auto e() const noexcept -> int; }; }"};
+	c.parse(p);
+	std::ostringstream os;
+	cwcc::generate(os, c);
+	const auto result{os.str()};
+
+	REQUIRE(result.find("[[cwc::") == std::string::npos); //directives are not emitted
+	REQUIRE(result.find("std::size_t cwc_capacity{24};") != std::string::npos);
+	REQUIRE(result.find("alignas(std::max_align_t) unsigned char cwc_storage[cwc_capacity];") != std::string::npos);
+	REQUIRE(result.find("cwc_binding = cwc_context().construct_at<&cwc_vtable::cwc_1>(cwc_vptr, &cwc_self, cwc_storage, cwc::internal::pass(d));") != std::string::npos);
+	REQUIRE(result.find("*cwc_self = cwc::internal::create_at<CWCImpl, CWCAllocation>(*cwc_self, cwc::internal::take<int>(d));") != std::string::npos);
+	REQUIRE(result.find("void(*cwc_0)(cwc::internal::call_context<void, true> *, void *) noexcept;\nvoid(*cwc_destroy_at)(void *) noexcept;\nvoid(*cwc_relocate)(void *, void *) noexcept;") != std::string::npos); //independent of the version
+	REQUIRE(result.find("cwc::internal::header::of<CWCImpl>(cwc_version, true),") != std::string::npos); //announces these entries
+	REQUIRE(result.find("return cwc::internal::context::probe(\"b\", \"1a1c\", cwc_version, cwc_capacity);") != std::string::npos);
+	REQUIRE(result.find("cwc::internal::context::destroy<&cwc_vtable::cwc_0, &cwc_vtable::cwc_destroy_at>(cwc_binding, cwc_self, cwc_storage);") != std::string::npos);
+	REQUIRE(result.find("cwc_vptr.call<&cwc_vtable::cwc_relocate>(cwc_self = cwc_storage, cwc_other.cwc_storage);") != std::string::npos);
+}
+
+TEST_CASE("generating_allocation", "[generating]") {
+	cwcc::cwc c;
+	cwcc::parser p{"namespace a { @library(\"b\") @version(0) component c { c(int d); }; }"};
+	c.parse(p);
+	std::ostringstream os;
+	cwcc::generate(os, c);
+	const auto result{os.str()};
+
+	REQUIRE(result.find("#define CWC_EXPORT_1a1c(...) ") != std::string::npos); //optional allocation policy
+	REQUIRE(result.find("::template export_<__VA_ARGS__>()}; ") != std::string::npos);
+	REQUIRE(result.find("const cwc::internal::export_entry cwc_export_1a1c{\"1a1c\", \"b\", &cwc_vtable_1a1c}") != std::string::npos); //listed in the export table
+	REQUIRE(result.find("#define CWC_EXPORTS_b() CWC_LOCAL extern const cwc::internal::export_entry cwc_export_1a1c; CWC_EXPORTS(cwc::internal::exported{cwc::internal::hash(\"1a1c\"), &cwc_export_1a1c})") != std::string::npos); //one table per library
+	REQUIRE(result.find("extern \"C\"") == std::string::npos); //only the export table is exported
+	REQUIRE(result.find("*cwc_self = cwc::internal::create<CWCImpl, CWCAllocation>(cwc::internal::take<int>(d));") != std::string::npos);
+	REQUIRE(result.find("cwc::internal::destroy<CWCImpl, CWCAllocation>(cwc_self);") != std::string::npos);
+}
@@ -22,6 +22,8 @@ TEST_CASE("parsing_attribute", "[parsing] [attribute]") {
 	REQUIRE(attribute("[[nodiscard(\"allocates memory\")]]") == cwcc::attribute{"nodiscard", "\"allocates memory\""});
 	REQUIRE(attribute("[[deprecated(\"outdated interface\")]]") == cwcc::attribute{"deprecated", "\"outdated interface\""});
 
+	REQUIRE(attribute("[[gnu::pure]]") == cwcc::attribute{"gnu::pure", {}});
+
 	REQUIRE_THROWS(attribute("[[nodiscard()"));
 	REQUIRE_THROWS(attribute("[[nodiscard, deprecated]]"));
 }
@@ -244,6 +246,47 @@ TEST_CASE("parsing_static method", "[parsing] [method]") {
 	REQUIRE_THROWS(method("static void operator()();"));
 }
 
+TEST_CASE("parsing_method_batch", "[parsing] [method]") {
+	auto method{[](const char * str) {
+		cwcc::method res;
+		cwcc::parser p{str};
+		res.parse(p);
+		return res;
+	}};
+
+	REQUIRE(method("[[cwc::batch]] auto func(int a) const -> int;") == cwcc::method{false, "func", {{false, "int", cwcc::ref_t::none, "a"}}, true, cwcc::ref_t::none, false, "int", false, true});
+	REQUIRE(method("[[cwc::batch]] auto func(const std::string & a) noexcept -> int;") == cwcc::method{false, "func", {{true, "std::string", cwcc::ref_t::lvalue, "a"}}, false, cwcc::ref_t::none, true, "int", false, true});
+
+	REQUIRE_THROWS(method("[[cwc::batch]] void func(int a);"));
+	REQUIRE_THROWS(method("[[cwc::batch]] auto func() -> int;"));
+	REQUIRE_THROWS(method("[[cwc::batch]] auto func(int a, int b) -> int;"));
+	REQUIRE_THROWS(method("[[cwc::batch]] auto func(int & a) -> int;"));
+	REQUIRE_THROWS(method("[[cwc::batch]] static auto func(int a) -> int;"));
+	REQUIRE_THROWS(method("[[cwc::batch]] auto func(int a) && -> int;"));
+	REQUIRE_THROWS(method("[[cwc::unknown]] auto func(int a) -> int;"));
+}
+
+TEST_CASE("parsing_method_pure", "[parsing] [method]") {
+	auto method{[](const char * str) {
+		cwcc::method res;
+		cwcc::parser p{str};
+		res.parse(p);
+		return res;
+	}};
+
+	REQUIRE(method("[[cwc::pure]] auto func(int a) const -> int;") == cwcc::method{false, "func", {{false, "int", cwcc::ref_t::none, "a"}}, true, cwcc::ref_t::none, false, "int", false, false, ""});
+	REQUIRE(method("[[cwc::pure(4)]] static auto func() noexcept -> int;") == cwcc::method{true, "func", {}, false, cwcc::ref_t::none, true, "int", false, false, "4"});
+	REQUIRE(method("[[cwc::batch]] [[cwc::pure]] auto func(const std::string & a) const -> int;") == cwcc::method{false, "func", {{true, "std::string", cwcc::ref_t::lvalue, "a"}}, true, cwcc::ref_t::none, false, "int", false, true, ""});
+
+	REQUIRE_THROWS(method("[[cwc::pure]] auto func(int a) -> int;"));
+	REQUIRE_THROWS(method("[[cwc::pure]] void func(int a) const;"));
+	REQUIRE_THROWS(method("[[cwc::pure]] auto func(int & a) const -> int;"));
+	REQUIRE_THROWS(method("[[cwc::pure]] auto func(int && a) const -> int;"));
+	REQUIRE_THROWS(method("[[cwc::pure(0)]] auto func(int a) const -> int;"));
+	REQUIRE_THROWS(method("[[cwc::pure(-1)]] auto func(int a) const -> int;"));
+	REQUIRE_THROWS(method("[[cwc::pure(\"a\")]] auto func(int a) const -> int;"));
+}
+
 TEST_CASE("parsing_using", "[parsing] [using]") {
 	auto using_{[](const char * str) {
 		cwcc::using_ res;
@@ -271,6 +314,11 @@ TEST_CASE("parsing_component", "[parsing] [component]") {
 
 	REQUIRE(component("@version(2) component comp { comp(int val); };") == cwcc::component{"2", {}, "comp", false, {cwcc::constructor{false, "comp", {{false, "int", cwcc::ref_t::none, "val"}}, false}}});
 	REQUIRE(component("@version(3) component comp final { comp(int val); };") == cwcc::component{"3", {}, "comp", true, {cwcc::constructor{false, "comp", {{false, "int", cwcc::ref_t::none, "val"}}, false}}});
+	REQUIRE(component("@version(4) component [[cwc::inline_storage(32)]] comp final {};") == cwcc::component{"4", {}, "comp", true, {}, "32"});
+
+	REQUIRE_THROWS(component("@version(0) component [[cwc::inline_storage]] comp {};"));
+	REQUIRE_THROWS(component("@version(0) component [[cwc::inline_storage(0)]] comp {};"));
+	REQUIRE_THROWS(component("@version(0) component [[cwc::batch]] comp {};"));
 
 	REQUIRE_THROWS(component("@version(00) component comp {};"));
 	REQUIRE_THROWS(component("@version(a) component comp {};"));